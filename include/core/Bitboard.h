@@ -0,0 +1,146 @@
+#pragma once
+
+#include "core/Types.h"
+#include <array>
+#include <cstdint>
+#include <string>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define CHESS_HAS_PEXT 1
+#include <immintrin.h>
+#else
+#define CHESS_HAS_PEXT 0
+#endif
+
+namespace Chess {
+
+    // A set of squares, one bit per square.
+    // Squares are indexed as y * 8 + x, the same layout Position uses, so bit 0 is a8 and bit 63 is h1.
+    using Bitboard = uint64_t;
+
+    constexpr int SQUARE_NB = 64;
+    constexpr int COLOR_NB = 2;
+    constexpr int PIECE_TYPE_NB = 7;  // Indexed by PieceType, slot 0 (EMPTY) is unused
+
+    constexpr Bitboard FILE_A_BB = 0x0101010101010101ULL;
+    constexpr Bitboard FILE_H_BB = FILE_A_BB << 7;
+    constexpr Bitboard ROW_0_BB = 0xFFULL;           // Eighth rank
+    constexpr Bitboard ROW_7_BB = ROW_0_BB << 56;    // First rank
+
+    // Square and color helpers
+    constexpr int MakeSquare(int x, int y) { return y * BOARD_SIZE + x; }
+    constexpr int SquareFile(int sq) { return sq & 7; }
+    constexpr int SquareRow(int sq) { return sq >> 3; }
+    inline Position SquareToPosition(int sq) { return Position(static_cast<int8_t>(sq & 7), static_cast<int8_t>(sq >> 3)); }
+    inline int PositionToSquare(const Position& pos) { return MakeSquare(pos.x, pos.y); }
+
+    constexpr int ColorIndex(Color c) { return c == Color::WHITE ? 0 : 1; }
+    constexpr Color Opponent(Color c) { return c == Color::WHITE ? Color::BLACK : Color::WHITE; }
+
+    constexpr Bitboard SquareBB(int sq) { return 1ULL << sq; }
+    constexpr Bitboard FileBB(int x) { return FILE_A_BB << x; }
+    constexpr Bitboard RowBB(int y) { return ROW_0_BB << (8 * y); }
+
+    // Bit manipulation
+    inline int PopCount(Bitboard b) {
+#if defined(_MSC_VER)
+        return static_cast<int>(__popcnt64(b));
+#else
+        return __builtin_popcountll(b);
+#endif
+    }
+
+    // Index of the least significant set bit. b must be non-zero.
+    inline int Lsb(Bitboard b) {
+#if defined(_MSC_VER)
+        unsigned long idx;
+        _BitScanForward64(&idx, b);
+        return static_cast<int>(idx);
+#else
+        return __builtin_ctzll(b);
+#endif
+    }
+
+    // Returns the least significant square and clears it from b.
+    inline int PopLsb(Bitboard& b) {
+        int sq = Lsb(b);
+        b &= b - 1;
+        return sq;
+    }
+
+    inline bool MoreThanOne(Bitboard b) { return (b & (b - 1)) != 0; }
+
+    // Shifts towards the eighth rank (north) decrease the square index.
+    constexpr Bitboard ShiftNorth(Bitboard b) { return b >> 8; }
+    constexpr Bitboard ShiftSouth(Bitboard b) { return b << 8; }
+
+#if CHESS_HAS_PEXT
+#if defined(_MSC_VER)
+    inline uint64_t Pext(uint64_t b, uint64_t mask) { return _pext_u64(b, mask); }
+#else
+    // Compiled for BMI2 regardless of the global flags, only called once the CPU is known to support it.
+    __attribute__((target("bmi2"))) inline uint64_t Pext(uint64_t b, uint64_t mask) { return _pext_u64(b, mask); }
+#endif
+#endif
+
+    namespace Bitboards {
+
+        // Precomputed attack sets for the leaping pieces, filled once at startup.
+        extern std::array<std::array<Bitboard, SQUARE_NB>, COLOR_NB> PawnAttacks;
+        extern std::array<Bitboard, SQUARE_NB> KnightAttacks;
+        extern std::array<Bitboard, SQUARE_NB> KingAttacks;
+
+        // Squares strictly between two aligned squares, and the full line through them.
+        // Both are empty when the squares do not share a rank, file or diagonal.
+        extern std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> Between;
+        extern std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> Line;
+
+        // True when the CPU supports BMI2, in which case slider tables are indexed with PEXT
+        // instead of magic multiplication. Decided once at startup.
+        extern bool UsePext;
+
+        // Per-square entry into the sliding attack tables.
+        struct Magic {
+            Bitboard mask;       // Relevant occupancy, board edges excluded
+            Bitboard magic;      // Multiplier mapping masked occupancy to a unique index
+            Bitboard* attacks;   // Start of this square's slice of the attack table
+            unsigned shift;
+
+            unsigned Index(Bitboard occupied) const {
+#if CHESS_HAS_PEXT
+                if (UsePext) return static_cast<unsigned>(Pext(occupied, mask));
+#endif
+                return static_cast<unsigned>(((occupied & mask) * magic) >> shift);
+            }
+
+            Bitboard Attacks(Bitboard occupied) const { return attacks[Index(occupied)]; }
+        };
+
+        extern std::array<Magic, SQUARE_NB> RookMagics;
+        extern std::array<Magic, SQUARE_NB> BishopMagics;
+
+        // Sliding attacks computed by walking the rays against the given occupancy.
+        // Only used to build the tables; use RookAttacksFrom/BishopAttacksFrom instead.
+        Bitboard RookAttacksSlow(int sq, Bitboard occupied);
+        Bitboard BishopAttacksSlow(int sq, Bitboard occupied);
+
+        std::string ToString(Bitboard b);
+
+    } // namespace Bitboards
+
+    inline Bitboard PawnAttacksFrom(Color c, int sq) { return Bitboards::PawnAttacks[ColorIndex(c)][sq]; }
+    inline Bitboard KnightAttacksFrom(int sq) { return Bitboards::KnightAttacks[sq]; }
+    inline Bitboard KingAttacksFrom(int sq) { return Bitboards::KingAttacks[sq]; }
+    inline Bitboard RookAttacksFrom(int sq, Bitboard occupied) { return Bitboards::RookMagics[sq].Attacks(occupied); }
+    inline Bitboard BishopAttacksFrom(int sq, Bitboard occupied) { return Bitboards::BishopMagics[sq].Attacks(occupied); }
+    inline Bitboard BetweenBB(int a, int b) { return Bitboards::Between[a][b]; }
+    inline Bitboard LineBB(int a, int b) { return Bitboards::Line[a][b]; }
+    inline bool Aligned(int a, int b, int c) { return (LineBB(a, b) & SquareBB(c)) != 0; }
+
+    inline Bitboard QueenAttacksFrom(int sq, Bitboard occupied) { return RookAttacksFrom(sq, occupied) | BishopAttacksFrom(sq, occupied); }
+
+} // namespace Chess
@@ -1,22 +1,58 @@
 #pragma once
 
 #include "core/Types.h"
+#include "core/Bitboard.h"
+#include "core/MoveList.h"
+#include "core/Nnue.h"
+#include "core/Pawns.h"
+#include "core/Psqt.h"
 #include <array>
 #include <vector>
 #include <string>
 
 namespace Chess {
 
+// Castling right bits, combined in Board's castling mask
+constexpr uint8_t WHITE_KING_SIDE = 1;
+constexpr uint8_t WHITE_QUEEN_SIDE = 2;
+constexpr uint8_t BLACK_KING_SIDE = 4;
+constexpr uint8_t BLACK_QUEEN_SIDE = 8;
+
+// State that a move destroys and UndoMove has to put back
+struct StateInfo {
+    CompactMove move;
+    Piece captured;
+    uint8_t castlingRights;
+    Position enPassantTarget;
+    int halfMoveClock;
+    int pliesFromNull;
+    Bitboard checkers;
+    std::array<Bitboard, COLOR_NB> blockersForKing;
+    std::array<Bitboard, PIECE_TYPE_NB> checkSquares;
+    uint64_t key;
+    uint64_t pawnKey;
+    uint64_t materialKey;
+};
+
 class Board {
 private:
-    std::array<std::array<Piece, BOARD_SIZE>, BOARD_SIZE> squares;
+    // Mailbox for O(1) piece lookup, kept in step with the bitboards below
+    std::array<Piece, SQUARE_NB> mailbox;
+
+    // One bitboard per color and piece type, plus occupancy masks
+    std::array<std::array<Bitboard, PIECE_TYPE_NB>, COLOR_NB> pieceBB;
+    std::array<Bitboard, COLOR_NB> colorBB;
+    Bitboard occupiedBB;
+
     Color currentPlayer;
 
-    // Castling rights
-    bool whiteKingSideCastle;
-    bool whiteQueenSideCastle;
-    bool blackKingSideCastle;
-    bool blackQueenSideCastle;
+    // Check information for the current position, refreshed by SetCheckInfo
+    Bitboard checkersBB;                               // Enemy pieces giving check to the side to move
+    std::array<Bitboard, COLOR_NB> blockersForKing;    // Pieces (of either color) shielding each king from a slider
+    std::array<Bitboard, PIECE_TYPE_NB> checkSquares;  // Where each piece type of the side to move would give check
+
+    // Castling rights, a mask of the *_SIDE bits above
+    uint8_t castlingRights;
 
     // En passant
     Position enPassantTarget;
@@ -24,9 +60,30 @@ private:
     // Move counters
     int halfMoveClock;  // For 50-move rule
     int fullMoveNumber;
-
-    // Game history for repetition detection
-    std::vector<std::string> positionHistory;
+    int pliesFromNull;  // Plies since the last null move (or setup), bounds the repetition scan
+
+    // Zobrist keys of the position, its pawns and its material, updated incrementally
+    uint64_t key;
+    uint64_t pawnKey;
+    uint64_t materialKey;
+
+    // Material and piece-square score (white-relative) and game phase, updated
+    // incrementally as pieces are put and removed
+    Score psqt;
+    int gamePhase;
+
+    // Network first layer, maintained alongside the pieces only while nnueEnabled.
+    // DoMove saves it on the stack and UndoMove restores it from there.
+    NNUE::Accumulator accumulator;
+    NNUE::AccumulatorStack accumulatorStack;
+    bool nnueEnabled;
+
+    // One entry per move played, newest last. Also serves as the key history for
+    // repetition detection. Only the first stateCount entries are live; the vector
+    // keeps its high-water size so search plies reuse entries instead of allocating,
+    // and grows with the game, so no history is ever dropped.
+    std::vector<StateInfo> stateStack;
+    int stateCount;
 
 public:
     Board();
@@ -44,10 +101,19 @@ public:
     void SetPiece(int x, int y, const Piece& piece);
     bool IsEmpty(const Position& pos) const;
 
+    // Bitboard access
+    Bitboard Pieces(Color color, PieceType type) const { return pieceBB[ColorIndex(color)][static_cast<int>(type)]; }
+    Bitboard Pieces(Color color) const { return colorBB[ColorIndex(color)]; }
+    Bitboard Pieces(PieceType type) const {
+        return pieceBB[0][static_cast<int>(type)] | pieceBB[1][static_cast<int>(type)];
+    }
+    Bitboard Occupied() const { return occupiedBB; }
+    const Piece& PieceOn(int sq) const { return mailbox[sq]; }
+
     // Game state
     Color GetCurrentPlayer() const { return currentPlayer; }
-    void SetCurrentPlayer(Color color) { currentPlayer = color; }
-    void SwitchPlayer() { currentPlayer = (currentPlayer == Color::WHITE) ? Color::BLACK : Color::WHITE; }
+    void SetCurrentPlayer(Color color);
+    void SwitchPlayer() { SetCurrentPlayer(Opponent(currentPlayer)); }
 
     // Castling rights
     bool CanCastleKingSide(Color color) const;
@@ -57,8 +123,8 @@ public:
 
     // En passant
     Position GetEnPassantTarget() const { return enPassantTarget; }
-    void SetEnPassantTarget(const Position& target) { enPassantTarget = target; }
-    void ClearEnPassantTarget() { enPassantTarget = Position(); }
+    void SetEnPassantTarget(const Position& target);
+    void ClearEnPassantTarget();
 
     // Move counters
     int GetHalfMoveClock() const { return halfMoveClock; }
@@ -70,14 +136,53 @@ public:
     // Position analysis
     Position FindKing(Color color) const;
     bool IsInCheck(Color color) const;
+    bool InCheck() const { return checkersBB != 0; }  // Side to move
+    Bitboard Checkers() const { return checkersBB; }
+    Bitboard BlockersForKing(Color color) const { return blockersForKing[ColorIndex(color)]; }
+    Bitboard PinnedPieces(Color color) const { return blockersForKing[ColorIndex(color)] & Pieces(color); }
     bool IsSquareAttacked(const Position& pos, Color attackingColor) const;
+    Bitboard AttackersTo(int sq, Bitboard occupied) const;
+    // Static exchange evaluation: true if the capture sequence started by move on its
+    // destination square wins at least threshold centipawns for the mover, with both
+    // sides always recapturing with their least valuable attacker. Pins are ignored.
+    bool SEE(CompactMove move, int threshold) const;
     std::vector<Move> GetAllLegalMoves(Color color) const;
     std::vector<Move> GetPieceMoves(const Position& pos) const;
 
+    // Allocation-free move generation for the side to move (or the given color)
+    void GenerateMoves(GenType type, MoveList& moves) const { GenerateMoves(type, moves, currentPlayer); }
+    void GenerateMoves(GenType type, MoveList& moves, Color color) const;
+    // Cheap legality test for a pseudo-legal move of the side to move, using the cached
+    // pins and checkers. Search calls it only when it is about to play the move.
+    bool IsLegal(CompactMove move) const;
+    // True if move is one the generator could produce for the side to move here. Moves
+    // taken from other positions (TT, killers, counter moves) must pass it before IsLegal.
+    bool IsPseudoLegal(CompactMove move) const;
+    // Whether a legal move of the side to move checks the opponent, decided from the
+    // cached check squares and blockers without playing it
+    bool GivesCheck(CompactMove move) const;
+    Move ToMove(CompactMove move) const;   // Expands with the captured piece filled in
+
     // Move validation and execution
     bool IsLegalMove(const Move& move) const;
-    bool MakeMove(const Move& move);
-    bool UndoMove(const Move& move);  // For search algorithms
+    bool MakeMove(const Move& move);   // Validates, then plays the move
+    bool UndoMove(const Move& move);   // Takes back move, false unless it was the last one played
+
+    // Unchecked make/unmake for search. The move must be legal, and UndoMove must
+    // be given the same move DoMove last played.
+    void DoMove(CompactMove move);
+    void UndoMove(CompactMove move);
+    int GetPlyCount() const { return stateCount; }
+
+    // Move played pliesAgo plies back, invalid for a null move or before the game record
+    CompactMove PreviousMove(int pliesAgo = 1) const {
+        return pliesAgo <= stateCount ? stateStack[stateCount - pliesAgo].move : CompactMove();
+    }
+
+    // Passes the turn, for null-move pruning. The side to move must not be in check.
+    void DoNullMove();
+    void UndoNullMove();
+    bool LastMoveWasNull() const { return stateCount > 0 && pliesFromNull == 0; }
 
     // Game state evaluation
     GameResult GetGameResult() const;
@@ -85,21 +190,32 @@ public:
     bool IsCheckmate(Color color) const;
     bool IsInsufficientMaterial() const;
     bool IsThreefoldRepetition() const;
+    bool IsRepetition() const;   // Twofold, for search: the position occurred before
 
     // Board evaluation (for AI)
-    float EvaluatePosition(Color perspective) const;
-    float GetPieceValue(PieceType type) const;
-    float GetPositionValue(const Position& pos, PieceType type, Color color) const;
+    // Classical: material, tapered PSQT and pawn structure. Pawn terms come from the
+    // given cache, or are computed from scratch without one.
+    Value EvaluatePosition(Color perspective, PawnTable* pawns = nullptr) const;
+    // Network evaluation while UseNnue is on, EvaluatePosition otherwise. Refreshes an
+    // accumulator half that a king move left stale, hence not const.
+    Value Evaluate(Color perspective, PawnTable* pawns = nullptr);
+    // Starts or stops maintaining the network accumulator. Enabling needs a loaded
+    // network, and has to be repeated after another network is loaded.
+    void UseNnue(bool enable);
+    bool UsingNnue() const { return nnueEnabled; }
+    Value GetPieceValue(PieceType type) const;
+    Score GetPsqtScore() const { return psqt; }
+    int GetGamePhase() const { return gamePhase; }   // MAX_PHASE at the start, 0 with only kings and pawns
 
     // String representations
     std::string ToFEN() const;
     bool LoadFromFEN(const std::string& fen);
     std::string ToString() const;  // Human-readable format
 
-    // Position hashing for repetition detection
-    std::string GetPositionHash() const;
-    void AddToHistory();
-    void ClearHistory();
+    // Zobrist keys
+    uint64_t GetKey() const { return key; }
+    uint64_t GetPawnKey() const { return pawnKey; }
+    uint64_t GetMaterialKey() const { return materialKey; }
 
     // Utility functions
     bool IsValidPosition(const Position& pos) const;
@@ -107,27 +223,27 @@ public:
     static bool IsValidSquare(int x, int y);
 
 private:
-    // Internal move generation helpers
-    std::vector<Move> GetPawnMoves(const Position& pos) const;
-    std::vector<Move> GetRookMoves(const Position& pos) const;
-    std::vector<Move> GetKnightMoves(const Position& pos) const;
-    std::vector<Move> GetBishopMoves(const Position& pos) const;
-    std::vector<Move> GetQueenMoves(const Position& pos) const;
-    std::vector<Move> GetKingMoves(const Position& pos) const;
+    // Low-level piece placement, keeps mailbox and bitboards in step
+    void PutPiece(int sq, const Piece& piece);
+    void RemovePiece(int sq);
+
+    // Internal move generation helpers, each appends pseudo-legal moves landing on targets
+    void GeneratePawnMoves(MoveList& moves, Color us, GenType type, Bitboard targets) const;
+    void GeneratePieceMoves(MoveList& moves, Color us, PieceType type, Bitboard targets) const;
+    void GenerateCastling(MoveList& moves, Color us) const;
+    static void AddPromotions(MoveList& moves, int from, int to);
 
     // Helper functions for move validation
-    std::vector<Move> GetSlidingMoves(const Position& pos, const std::vector<Position>& directions) const;
-    bool WouldBeInCheck(const Move& move, Color color) const;
-    void UpdateCastlingRights(const Move& move, const Piece& movingPiece, const Piece& capturedPiece);
-    void UpdateEnPassant(const Move& move, const Piece& movingPiece);
-
-    // Position evaluation helpers
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> PAWN_TABLE;
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> KNIGHT_TABLE;
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> BISHOP_TABLE;
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> ROOK_TABLE;
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> QUEEN_TABLE;
-    static const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> KING_TABLE;
+    bool IsLegal(CompactMove move, Color us) const;
+    void MovePiece(int from, int to);
+    void PushState(const StateInfo& state);
+    void SetCheckInfo();
+    void SetCheckSquares();   // For the side to move, part of SetCheckInfo
+    void SetKeys();   // Recomputes all keys from scratch, used after setup changes
+    int RepetitionCount(int limit) const;   // Earlier occurrences of this position, up to limit
+    Bitboard SliderBlockers(Bitboard sliders, int sq) const;
+    Score ComputePsqt() const;   // From scratch, to verify the incremental score
+    void UpdateAccumulator(const Piece& piece, int sq, bool added);
 };
 
 } // namespace Chess
\ No newline at end of file
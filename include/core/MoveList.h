@@ -0,0 +1,61 @@
+#pragma once
+
+#include "core/Types.h"
+#include <array>
+#include <cstddef>
+
+namespace Chess {
+
+    // Upper bound on the number of moves in any reachable position (the known maximum is 218).
+    constexpr int MAX_MOVES = 256;
+
+    // Which subset of moves a generator call should produce.
+    enum class GenType : uint8_t {
+        CAPTURES = 0,      // Captures, en passant and promotions
+        QUIETS = 1,        // Non-capturing, non-promoting moves including castling
+        EVASIONS = 2,      // Moves that may get the side to move out of check
+        NON_EVASIONS = 3,  // CAPTURES + QUIETS, for positions not in check
+        LEGAL = 4          // Every legal move
+    };
+
+    /**
+     * @class MoveList
+     * @brief Fixed-capacity move container that lives on the stack.
+     *
+     * Generators append into it in place, so producing the moves of a node never
+     * touches the heap. Entries are 16-bit CompactMoves, so a full list is 512 bytes.
+     */
+    class MoveList {
+    public:
+        MoveList() : count(0) {}
+
+        void Add(CompactMove move) { moves[count++] = move; }
+        void Clear() { count = 0; }
+
+        // Keeps only the first size entries.
+        void Resize(size_t size) { count = size; }
+
+        size_t Size() const { return count; }
+        bool Empty() const { return count == 0; }
+
+        bool Contains(CompactMove move) const {
+            for (size_t i = 0; i < count; ++i) {
+                if (moves[i] == move) return true;
+            }
+            return false;
+        }
+
+        CompactMove& operator[](size_t index) { return moves[index]; }
+        const CompactMove& operator[](size_t index) const { return moves[index]; }
+
+        CompactMove* begin() { return moves.data(); }
+        CompactMove* end() { return moves.data() + count; }
+        const CompactMove* begin() const { return moves.data(); }
+        const CompactMove* end() const { return moves.data() + count; }
+
+    private:
+        std::array<CompactMove, MAX_MOVES> moves;
+        size_t count;
+    };
+
+} // namespace Chess
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "core/Bitboard.h"
+#include "core/Types.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Chess {
+
+    class Board;
+
+    // Efficiently updatable neural network evaluation.
+    //
+    // Features are HalfKP: for each perspective, every non-king piece is one input
+    // indexed by that side's king square, the piece and its square, with black's view
+    // mirrored vertically so both sides see the board from their own first rank. The
+    // first layer is a sum of weight columns, kept up to date piece by piece as the
+    // accumulator; only the small layers behind it run at every evaluation.
+    //
+    //   2 x L1_SIZE int16 accumulator -> clipped to [0, 127] as uint8
+    //   -> L2_SIZE (int8 weights, int32 sums) -> clipped -> L3_SIZE -> clipped -> 1
+    namespace NNUE {
+
+        constexpr int FEATURE_PIECES = 10;   // Pawn, rook, knight, bishop, queen of each side
+        constexpr int INPUT_SIZE = SQUARE_NB * FEATURE_PIECES * SQUARE_NB;
+        constexpr int L1_SIZE = 256;
+        constexpr int L2_SIZE = 32;
+        constexpr int L3_SIZE = 32;
+
+        // Hidden layer sums are shifted right by WEIGHT_SHIFT before clipping; the
+        // output sum divided by OUTPUT_SCALE is in centipawns
+        constexpr int WEIGHT_SHIFT = 6;
+        constexpr int OUTPUT_SCALE = 16;
+
+        // Weight file header. Any change to the layout or the constants above needs a
+        // new version, so an old network is rejected rather than misread.
+        constexpr uint32_t FILE_MAGIC = 0x4E4E4345;   // "ECNN" when read little-endian
+        constexpr uint32_t FILE_VERSION = 1;
+
+        // First layer output of a position, one half per perspective (ColorIndex). A half
+        // that is not computed has to be refreshed from scratch before use, which is the
+        // case after its own king moved.
+        struct Accumulator {
+            alignas(64) int16_t values[COLOR_NB][L1_SIZE];
+            bool computed[COLOR_NB];
+        };
+
+        // Accumulators of the positions a line of moves passed through, newest last, so
+        // taking a move back restores its parent's accumulator instead of recomputing it.
+        // A copy starts out empty: the saved entries belong to the moves played on the
+        // original, which the copy falls back to updating piece by piece.
+        class AccumulatorStack {
+        public:
+            AccumulatorStack() = default;
+            AccumulatorStack(const AccumulatorStack&) {}
+            AccumulatorStack& operator=(const AccumulatorStack&) { count = 0; return *this; }
+
+            // Keeps the high-water size, so a search reuses entries instead of allocating
+            void Push(const Accumulator& accumulator) {
+                if (count == entries.size()) {
+                    entries.push_back(accumulator);
+                } else {
+                    entries[count] = accumulator;
+                }
+                ++count;
+            }
+            void Pop(Accumulator& accumulator) { accumulator = entries[--count]; }
+            bool Empty() const { return count == 0; }
+            void Clear() { count = 0; }
+
+        private:
+            std::vector<Accumulator> entries;
+            size_t count = 0;
+        };
+
+        // Input index of a non-king piece as seen by perspective, whose king is on kingSq
+        inline int FeatureIndex(Color perspective, int kingSq, Color pieceColor, PieceType type, int sq) {
+            if (perspective == Color::BLACK) {
+                kingSq ^= 56;
+                sq ^= 56;
+            }
+            int piece = (pieceColor == perspective ? 0 : 5) + static_cast<int>(type) - static_cast<int>(PieceType::PAWN);
+            return (kingSq * FEATURE_PIECES + piece) * SQUARE_NB + sq;
+        }
+
+        /**
+         * @brief Loads network weights, replacing the current network.
+         *
+         * The file is the header (magic, version, L1_SIZE, L2_SIZE, L3_SIZE as uint32)
+         * followed by every layer's biases then weights, input layer first, all
+         * little-endian: int16 feature biases [L1] and weights [INPUT_SIZE][L1], then for
+         * each hidden layer int32 biases [out] and int8 weights [out][in], and the int32
+         * output bias with int8 output weights [L3]. Must not be called during a search.
+         *
+         * @param error Receives the reason on failure, if not null.
+         * @return false if the file is missing, of another version or the wrong size; the
+         *         previous network, if any, is kept.
+         */
+        bool LoadNetwork(const std::string& path, std::string* error = nullptr);
+        bool IsLoaded();
+
+        // Name of the kernels chosen for this CPU: "avx2", "sse4.1" or "scalar"
+        const char* KernelName();
+
+        // Adds or removes one feature in one perspective's half of the accumulator
+        void AddFeature(Accumulator& accumulator, Color perspective, int index);
+        void RemoveFeature(Accumulator& accumulator, Color perspective, int index);
+
+        // Recomputes one perspective's half from the pieces on the board
+        void Refresh(const Board& board, Color perspective, Accumulator& accumulator);
+
+        // Evaluation of a fully computed accumulator for the side to move
+        Value Evaluate(const Accumulator& accumulator, Color sideToMove);
+
+    } // namespace NNUE
+
+} // namespace Chess
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "core/Bitboard.h"
+#include "core/Psqt.h"
+#include "core/Types.h"
+#include <cstdint>
+#include <vector>
+
+namespace Chess {
+
+    class Board;
+
+    // Pawn structure of one position, everything in it determined by the pawns alone
+    // except the king shelter, which is cached for the king squares it was last asked for.
+    struct PawnEntry {
+        uint64_t key = 0;                   // Board::GetPawnKey of the position
+        Score score;                        // White-relative sum of the structure terms
+        Bitboard passedPawns[COLOR_NB];
+        Bitboard pawnAttacks[COLOR_NB];     // Squares attacked by each side's pawns now
+        Bitboard pawnAttacksSpan[COLOR_NB]; // Squares they could ever attack by advancing
+
+        // Midgame bonus for the pawns in front of color's king, computed on demand
+        Score KingShelter(const Board& board, Color color);
+
+    private:
+        friend void EvaluatePawns(const Board& board, PawnEntry& entry);
+        int shelterKingSquare[COLOR_NB];    // -1 while not computed
+        Score shelter[COLOR_NB];
+    };
+
+    // Fills entry from scratch: doubled, isolated, backward and passed pawns for both sides
+    void EvaluatePawns(const Board& board, PawnEntry& entry);
+
+    /**
+     * @class PawnTable
+     * @brief Cache of PawnEntry by pawn key, one per search thread.
+     *
+     * Pawn structure changes with few moves, so most evaluations (about 85-98% in
+     * searches) find their entry here instead of rescanning the pawns. Entries are
+     * replaced on collision.
+     */
+    class PawnTable {
+    public:
+        static constexpr size_t DEFAULT_ENTRIES = 16384;   // A power of two
+
+        explicit PawnTable(size_t entries = DEFAULT_ENTRIES);
+
+        // Reallocates to the largest power of two not above entries (at least one). Clears the table.
+        void Resize(size_t entries);
+        size_t Size() const { return entries.size(); }
+
+        // The entry for the board's pawns, computed first if it is not cached
+        PawnEntry* Probe(const Board& board);
+
+        void Clear();
+
+        // Lookups since construction or the last ResetCounters, and how many were cached
+        void ResetCounters() { probes = hits = 0; }
+        uint64_t Probes() const { return probes; }
+        uint64_t Hits() const { return hits; }
+
+    private:
+        std::vector<PawnEntry> entries;
+        uint64_t probes = 0;
+        uint64_t hits = 0;
+    };
+
+} // namespace Chess
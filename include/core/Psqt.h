@@ -0,0 +1,207 @@
+#pragma once
+
+#include "core/Bitboard.h"
+#include "core/Types.h"
+
+namespace Chess {
+
+    // A midgame and an endgame value for one evaluation term, in centipawns.
+    // Terms are summed in both phases and blended by game phase only at the end.
+    struct Score {
+        int mg = 0;
+        int eg = 0;
+
+        constexpr Score& operator+=(Score other) { mg += other.mg; eg += other.eg; return *this; }
+        constexpr Score& operator-=(Score other) { mg -= other.mg; eg -= other.eg; return *this; }
+        constexpr Score operator+(Score other) const { return { mg + other.mg, eg + other.eg }; }
+        constexpr Score operator-(Score other) const { return { mg - other.mg, eg - other.eg }; }
+        constexpr Score operator-() const { return { -mg, -eg }; }
+        constexpr bool operator==(Score other) const { return mg == other.mg && eg == other.eg; }
+    };
+
+    namespace PSQT {
+
+        // Game phase contributed by each piece type; the starting position adds up to MAX_PHASE
+        constexpr int PHASE_WEIGHTS[PIECE_TYPE_NB] = { 0, 0, 2, 1, 1, 4, 0 };
+        constexpr int MAX_PHASE = 24;
+
+        // Indexed by PieceType: EMPTY, PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING
+        constexpr Score PIECE_VALUES[PIECE_TYPE_NB] = {
+            { 0, 0 }, { 100, 120 }, { 500, 530 }, { 320, 300 }, { 330, 320 }, { 900, 940 }, { 0, 0 }
+        };
+
+        // Square bonuses from white's point of view, rank 8 first, so [y][x] as on Board
+        using Table = int[BOARD_SIZE][BOARD_SIZE];
+
+        constexpr Table PAWN_MG = {
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            { 50,  50,  50,  50,  50,  50,  50,  50 },
+            { 10,  10,  20,  30,  30,  20,  10,  10 },
+            {  5,   5,  10,  25,  25,  10,   5,   5 },
+            {  0,   0,   0,  20,  20,   0,   0,   0 },
+            {  5,  -5, -10,   0,   0, -10,  -5,   5 },
+            {  5,  10,  10, -20, -20,  10,  10,   5 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 }
+        };
+
+        // Passers decide endgames, so advancement counts for more than structure
+        constexpr Table PAWN_EG = {
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            { 80,  80,  80,  80,  80,  80,  80,  80 },
+            { 50,  50,  50,  50,  50,  50,  50,  50 },
+            { 30,  30,  30,  30,  30,  30,  30,  30 },
+            { 15,  15,  15,  15,  15,  15,  15,  15 },
+            {  5,   5,   5,   5,   5,   5,   5,   5 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 }
+        };
+
+        constexpr Table KNIGHT_MG = {
+            { -50, -40, -30, -30, -30, -30, -40, -50 },
+            { -40, -20,   0,   0,   0,   0, -20, -40 },
+            { -30,   0,  10,  15,  15,  10,   0, -30 },
+            { -30,   5,  15,  20,  20,  15,   5, -30 },
+            { -30,   0,  15,  20,  20,  15,   0, -30 },
+            { -30,   5,  10,  15,  15,  10,   5, -30 },
+            { -40, -20,   0,   5,   5,   0, -20, -40 },
+            { -50, -40, -30, -30, -30, -30, -40, -50 }
+        };
+
+        constexpr Table KNIGHT_EG = {
+            { -50, -40, -30, -30, -30, -30, -40, -50 },
+            { -40, -20,   0,   0,   0,   0, -20, -40 },
+            { -30,   0,  10,  15,  15,  10,   0, -30 },
+            { -30,   0,  15,  20,  20,  15,   0, -30 },
+            { -30,   0,  15,  20,  20,  15,   0, -30 },
+            { -30,   0,  10,  15,  15,  10,   0, -30 },
+            { -40, -20,   0,   0,   0,   0, -20, -40 },
+            { -50, -40, -30, -30, -30, -30, -40, -50 }
+        };
+
+        constexpr Table BISHOP_MG = {
+            { -20, -10, -10, -10, -10, -10, -10, -20 },
+            { -10,   0,   0,   0,   0,   0,   0, -10 },
+            { -10,   0,   5,  10,  10,   5,   0, -10 },
+            { -10,   5,   5,  10,  10,   5,   5, -10 },
+            { -10,   0,  10,  10,  10,  10,   0, -10 },
+            { -10,  10,  10,  10,  10,  10,  10, -10 },
+            { -10,   5,   0,   0,   0,   0,   5, -10 },
+            { -20, -10, -10, -10, -10, -10, -10, -20 }
+        };
+
+        constexpr Table BISHOP_EG = {
+            { -20, -10, -10, -10, -10, -10, -10, -20 },
+            { -10,   0,   0,   0,   0,   0,   0, -10 },
+            { -10,   0,   5,  10,  10,   5,   0, -10 },
+            { -10,   0,  10,  15,  15,  10,   0, -10 },
+            { -10,   0,  10,  15,  15,  10,   0, -10 },
+            { -10,   0,   5,  10,  10,   5,   0, -10 },
+            { -10,   0,   0,   0,   0,   0,   0, -10 },
+            { -20, -10, -10, -10, -10, -10, -10, -20 }
+        };
+
+        constexpr Table ROOK_MG = {
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  5,  10,  10,  10,  10,  10,  10,   5 },
+            { -5,   0,   0,   0,   0,   0,   0,  -5 },
+            { -5,   0,   0,   0,   0,   0,   0,  -5 },
+            { -5,   0,   0,   0,   0,   0,   0,  -5 },
+            { -5,   0,   0,   0,   0,   0,   0,  -5 },
+            { -5,   0,   0,   0,   0,   0,   0,  -5 },
+            {  0,   0,   0,   5,   5,   0,   0,   0 }
+        };
+
+        constexpr Table ROOK_EG = {
+            {  5,   5,   5,   5,   5,   5,   5,   5 },
+            { 10,  10,  10,  10,  10,  10,  10,  10 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 },
+            {  0,   0,   0,   0,   0,   0,   0,   0 }
+        };
+
+        constexpr Table QUEEN_MG = {
+            { -20, -10, -10,  -5,  -5, -10, -10, -20 },
+            { -10,   0,   0,   0,   0,   0,   0, -10 },
+            { -10,   0,   5,   5,   5,   5,   0, -10 },
+            {  -5,   0,   5,   5,   5,   5,   0,  -5 },
+            {   0,   0,   5,   5,   5,   5,   0,  -5 },
+            { -10,   5,   5,   5,   5,   5,   0, -10 },
+            { -10,   0,   5,   0,   0,   0,   0, -10 },
+            { -20, -10, -10,  -5,  -5, -10, -10, -20 }
+        };
+
+        constexpr Table QUEEN_EG = {
+            { -20, -10, -10,  -5,  -5, -10, -10, -20 },
+            { -10,   0,   5,   5,   5,   5,   0, -10 },
+            { -10,   5,  10,  10,  10,  10,   5, -10 },
+            {  -5,   5,  10,  15,  15,  10,   5,  -5 },
+            {  -5,   5,  10,  15,  15,  10,   5,  -5 },
+            { -10,   5,  10,  10,  10,  10,   5, -10 },
+            { -10,   0,   5,   5,   5,   5,   0, -10 },
+            { -20, -10, -10,  -5,  -5, -10, -10, -20 }
+        };
+
+        // Sheltered behind its pawns while the queens are on
+        constexpr Table KING_MG = {
+            { -30, -40, -40, -50, -50, -40, -40, -30 },
+            { -30, -40, -40, -50, -50, -40, -40, -30 },
+            { -30, -40, -40, -50, -50, -40, -40, -30 },
+            { -30, -40, -40, -50, -50, -40, -40, -30 },
+            { -20, -30, -30, -40, -40, -30, -30, -20 },
+            { -10, -20, -20, -20, -20, -20, -20, -10 },
+            {  20,  20,   0,   0,   0,   0,  20,  20 },
+            {  20,  30,  10,   0,   0,  10,  30,  20 }
+        };
+
+        // Centralized once there is little left to attack it with
+        constexpr Table KING_EG = {
+            { -50, -40, -30, -20, -20, -30, -40, -50 },
+            { -30, -20, -10,   0,   0, -10, -20, -30 },
+            { -30, -10,  20,  30,  30,  20, -10, -30 },
+            { -30, -10,  30,  40,  40,  30, -10, -30 },
+            { -30, -10,  30,  40,  40,  30, -10, -30 },
+            { -30, -10,  20,  30,  30,  20, -10, -30 },
+            { -30, -30,   0,   0,   0,   0, -30, -30 },
+            { -50, -30, -30, -30, -30, -30, -30, -50 }
+        };
+
+        struct Scores {
+            Score piece[COLOR_NB][PIECE_TYPE_NB][SQUARE_NB];
+        };
+
+        // Material plus square bonus for every colored piece on every square, signed
+        // so that black pieces count negative and a plain sum is white-relative
+        constexpr Scores GenerateScores() {
+            const Table* mg[PIECE_TYPE_NB] = { nullptr, &PAWN_MG, &ROOK_MG, &KNIGHT_MG, &BISHOP_MG, &QUEEN_MG, &KING_MG };
+            const Table* eg[PIECE_TYPE_NB] = { nullptr, &PAWN_EG, &ROOK_EG, &KNIGHT_EG, &BISHOP_EG, &QUEEN_EG, &KING_EG };
+
+            Scores scores{};
+            for (int p = 1; p < PIECE_TYPE_NB; ++p) {
+                for (int y = 0; y < BOARD_SIZE; ++y) {
+                    for (int x = 0; x < BOARD_SIZE; ++x) {
+                        Score score = PIECE_VALUES[p] + Score{ (*mg[p])[y][x], (*eg[p])[y][x] };
+                        scores.piece[ColorIndex(Color::WHITE)][p][y * BOARD_SIZE + x] = score;
+                        // Black reads the tables mirrored top to bottom
+                        scores.piece[ColorIndex(Color::BLACK)][p][(BOARD_SIZE - 1 - y) * BOARD_SIZE + x] = -score;
+                    }
+                }
+            }
+            return scores;
+        }
+
+        inline constexpr Scores SCORES = GenerateScores();
+
+        constexpr Score PieceScore(Color color, PieceType type, int sq) {
+            return SCORES.piece[ColorIndex(color)][static_cast<int>(type)][sq];
+        }
+
+        constexpr int PhaseWeight(PieceType type) {
+            return PHASE_WEIGHTS[static_cast<int>(type)];
+        }
+
+    } // namespace PSQT
+
+} // namespace Chess
@@ -14,6 +14,23 @@ namespace Chess {
     // Board constants
     constexpr int BOARD_SIZE = 8;
 
+    // Evaluations and search scores, in centipawns. Mate scores count down with the
+    // distance to mate, so a shorter mate always scores higher.
+    using Value = int;
+    constexpr int MAX_PLY = 128;
+    constexpr Value VALUE_ZERO = 0;
+    constexpr Value VALUE_DRAW = 0;
+    constexpr Value VALUE_MATE = 32000;
+    constexpr Value VALUE_INFINITE = 32001;
+    constexpr Value VALUE_MATE_IN_MAX_PLY = VALUE_MATE - MAX_PLY;
+
+    constexpr Value MateIn(int ply) { return VALUE_MATE - ply; }     // Mating at ply from the root
+    constexpr Value MatedIn(int ply) { return -VALUE_MATE + ply; }   // Getting mated at ply
+    constexpr bool IsMateValue(Value value) { return value >= VALUE_MATE_IN_MAX_PLY || value <= -VALUE_MATE_IN_MAX_PLY; }
+
+    // Pawn units for display; nothing inside the engine works in floating point
+    constexpr float ValueToPawns(Value value) { return static_cast<float>(value) / 100.0f; }
+
     // Enums (no changes needed here)
     enum class PieceType : int8_t { EMPTY = 0, PAWN = 1, ROOK = 2, KNIGHT = 3, BISHOP = 4, QUEEN = 5, KING = 6 };
     enum class Color : int8_t { WHITE = 1, BLACK = -1, NONE = 0 };
@@ -74,12 +91,46 @@ namespace Chess {
         std::string ToUCI() const;
         // -----------------------------------------
     };
+    /**
+     * @class CompactMove
+     * @brief 16-bit move encoding used by the search, move lists and transposition table.
+     *
+     * Bits 0-5 hold the from square and bits 6-11 the to square (both y * 8 + x),
+     * bits 12-13 the promotion piece (knight, bishop, rook, queen) and bits 14-15 the MoveType.
+     * The all-zero value (a8a8) is never a real move and serves as "no move".
+     */
+    class CompactMove {
+    public:
+        CompactMove() : data(0) {}
+        explicit CompactMove(uint16_t raw) : data(raw) {}
+        CompactMove(int from, int to, MoveType type = MoveType::NORMAL, PieceType promotion = PieceType::KNIGHT);
+        explicit CompactMove(const Move& move);
+
+        int From() const { return data & 0x3F; }
+        int To() const { return (data >> 6) & 0x3F; }
+        MoveType Type() const { return static_cast<MoveType>(data >> 14); }
+        PieceType Promotion() const;
+        uint16_t Raw() const { return data; }
+
+        bool IsValid() const { return data != 0; }
+        bool operator==(const CompactMove& other) const { return data == other.data; }
+        bool operator!=(const CompactMove& other) const { return data != other.data; }
+
+        // Expands to the rich Move. The captured piece needs the board, see Board::ToMove.
+        Move ToMove() const;
+        std::string ToUCI() const { return ToMove().ToUCI(); }
+
+    private:
+        uint16_t data;
+    };
+
     struct TimeControl {
         std::string name;
         std::chrono::milliseconds baseTime;
         std::chrono::milliseconds increment;
         std::chrono::milliseconds remainingTime;
-        TimeControl() : baseTime(0), increment(0), remainingTime(0) {}
+        int movesToGo;  // Moves until the next time control, 0 for sudden death
+        TimeControl() : baseTime(0), increment(0), remainingTime(0), movesToGo(0) {}
     };
 
     // FIXED: Constructor now initializes the 'timeControl' member
@@ -88,8 +139,10 @@ namespace Chess {
         bool isHuman;
         Difficulty difficulty;
         TimeControl timeControl;
+        size_t hashSizeMB;  // Transposition table budget for AI players
+        int searchThreads;  // Lazy SMP thread count for AI players
         PlayerConfig(const std::string& n = "Player", bool human = true, Difficulty diff = Difficulty::MEDIUM)
-            : name(n), isHuman(human), difficulty(diff), timeControl() {
+            : name(n), isHuman(human), difficulty(diff), timeControl(), hashSizeMB(16), searchThreads(1) {
         }
     };
 
@@ -120,9 +173,9 @@ namespace Chess {
         Move move;
         std::string algebraicNotation;
         std::chrono::milliseconds timeSpent;
-        float evaluation;
+        Value evaluation;   // White-relative
         int fullMoveNumber;
-        MoveHistoryEntry(const Move& m, const std::string& notation, std::chrono::milliseconds time, float eval, int moveNum)
+        MoveHistoryEntry(const Move& m, const std::string& notation, std::chrono::milliseconds time, Value eval, int moveNum)
             : move(m), algebraicNotation(notation), timeSpent(time), evaluation(eval), fullMoveNumber(moveNum) {
         }
     };
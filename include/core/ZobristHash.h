@@ -0,0 +1,72 @@
+#pragma once
+
+#include "core/Bitboard.h"
+#include "core/Types.h"
+#include <cstdint>
+
+namespace Chess {
+
+    class Board;
+
+    namespace Zobrist {
+
+        // SplitMix64 step, usable at compile time
+        constexpr uint64_t SplitMix64(uint64_t& state) {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        struct Keys {
+            uint64_t piece[COLOR_NB][PIECE_TYPE_NB][SQUARE_NB];
+            uint64_t sideToMove;
+            uint64_t castle[16];
+            uint64_t enPassant[BOARD_SIZE];
+        };
+
+        constexpr Keys GenerateKeys(uint64_t seed) {
+            Keys keys{};
+            for (int c = 0; c < COLOR_NB; ++c) {
+                for (int p = 0; p < PIECE_TYPE_NB; ++p) {
+                    for (int s = 0; s < SQUARE_NB; ++s) {
+                        keys.piece[c][p][s] = SplitMix64(seed);
+                    }
+                }
+            }
+            keys.sideToMove = SplitMix64(seed);
+            for (auto& k : keys.castle) k = SplitMix64(seed);
+            for (auto& k : keys.enPassant) k = SplitMix64(seed);
+            return keys;
+        }
+
+        // Generated at compile time from a fixed seed, so every process and every run
+        // hashes a given position to the same key. Changing the seed invalidates any
+        // key stored outside the process.
+        constexpr uint64_t SEED = 0x2545F4914F6CDD1DULL;
+        inline constexpr Keys KEYS = GenerateKeys(SEED);
+
+    } // namespace Zobrist
+
+    // Zobrist keys shared by every Board, plus full recomputation of a position's keys.
+    // Board keeps its keys up to date incrementally; the get*Hash functions are used to
+    // seed them after setup and to verify them in debug builds.
+    class ZobristHash {
+    public:
+        static constexpr uint64_t PieceKey(Color color, PieceType type, int sq) {
+            return Zobrist::KEYS.piece[ColorIndex(color)][static_cast<int>(type)][sq];
+        }
+        static constexpr uint64_t SideToMoveKey() { return Zobrist::KEYS.sideToMove; }
+        static constexpr uint64_t CastleKey(uint8_t rights) { return Zobrist::KEYS.castle[rights]; }
+        static constexpr uint64_t EnPassantKey(int file) { return Zobrist::KEYS.enPassant[file]; }
+
+        static uint64_t getHash(const Board& board);
+        static uint64_t getPawnHash(const Board& board);
+        static uint64_t getMaterialHash(const Board& board);
+
+        // True if the side to move has a pawn that could capture en passant. The en passant
+        // file only enters the key in that case, so otherwise identical positions match.
+        static bool EnPassantMatters(const Board& board);
+    };
+
+} // namespace Chess
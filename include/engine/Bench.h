@@ -0,0 +1,28 @@
+#pragma once
+
+#include <iosfwd>
+#include <string>
+
+namespace Chess {
+
+/**
+ * @brief Measures the parallel search backends against a single thread.
+ *
+ * Searches a fixed set of positions to a fixed depth, first with one thread and
+ * then with the given number of threads under each ParallelMode, and prints the
+ * time, node count, speedup (single-thread time / parallel time) and search
+ * overhead (extra nodes relative to the single-thread search) of each run.
+ */
+void RunParallelBench(std::ostream& out, int threads, int depth);
+
+/**
+ * @brief Measures static evaluation speed in evaluations per second.
+ *
+ * Plays every legal move of the bench positions, evaluates and takes it back, so the
+ * figures include the incremental updates a search pays for. Runs the classical
+ * evaluation, then the network loaded from networkPath with the kernels chosen for
+ * this CPU, unless networkPath is empty or does not load.
+ */
+void RunEvalBench(std::ostream& out, const std::string& networkPath);
+
+} // namespace Chess
@@ -1,68 +1,314 @@
 #pragma once
 
 #include "core/Board.h"
+#include "core/MoveList.h"
 #include "core/Types.h"
-#include "engine/ZobristHash.h" // Include the full definition
+#include "engine/MovePicker.h"
+#include "engine/TimeManager.h"
+#include "engine/TranspositionTable.h"
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <memory>
+#include <mutex>
 #include <limits>
 #include <vector>
-#include <unordered_map>
 
 namespace Chess {
 
+// How findBestMove uses more than one thread
+enum class ParallelMode : uint8_t {
+    LAZY_SMP = 0,   // Independent searches sharing the TT, then a vote
+    YBWC = 1        // Young Brothers Wait: helpers join split points of a single search
+};
+
+// Static evaluation used at the leaves
+enum class EvalType : uint8_t {
+    CLASSICAL = 0,  // Material and tapered piece-square tables
+    NNUE = 1        // The loaded network; classical while none is loaded
+};
+
+// Figures from the last findBestMove call, for tuning and benchmarking
+struct SearchStats {
+    int depth = 0;                        // Deepest iteration completed by the main thread
+    uint64_t nodes = 0;                   // Sum over all threads
+    std::vector<uint64_t> threadNodes;    // Per thread, main thread first
+    uint64_t splits = 0;                  // Split points created (YBWC only)
+    uint64_t pawnProbes = 0;              // Pawn table lookups, and how many found their entry
+    uint64_t pawnHits = 0;
+    std::chrono::milliseconds time{0};
+};
+
 /**
  * @class Engine
  * @brief Implements the core chess AI logic with advanced search techniques.
  *
  * This class is a major refactor of the Day 3 engine, adding iterative deepening,
  * transposition tables, and move ordering to improve performance and strength.
+ *
+ * With more than one thread it runs one of two backends. Lazy SMP: every thread
+ * searches the same root independently, sharing only the transposition table, and
+ * the threads vote on the move to play. YBWC: only the main thread iterates; once
+ * the eldest child of a node has been searched, the remaining siblings become a
+ * split point that idle helpers steal from.
  */
 class Engine {
-public:
-    // A simplified representation of a Transposition Table Entry.
-    struct TranspositionEntry {
-        // The value of a score relative to the alpha-beta bounds
-        enum class BoundType { EXACT, LOWERBOUND, UPPERBOUND };
+private:
+    static constexpr int MAX_SEARCH_DEPTH = 12;
+
+    // Root aspiration window: initial half-width in centipawns, and the first depth using it
+    static constexpr int ASPIRATION_WINDOW = 25;
+    static constexpr int ASPIRATION_MIN_DEPTH = 4;
+
+    // Null-move pruning: minimum depth to try it, and depth from which a fail high is verified
+    static constexpr int NULL_MOVE_MIN_DEPTH = 3;
+    static constexpr int NULL_MOVE_VERIFY_DEPTH = 8;
+
+    // Late move reductions apply from this depth, late move pruning and futility pruning
+    // of quiet moves up to the given depths
+    static constexpr int LMR_MIN_DEPTH = 3;
+    static constexpr int LMP_MAX_DEPTH = 8;
+    static constexpr int FUTILITY_MAX_DEPTH = 6;
+    static constexpr int FUTILITY_MARGIN = 100;   // Per ply of remaining depth
+
+    // SEE pruning up to this depth of moves losing more than the margin in exchanges:
+    // per ply for captures, per squared ply for quiet moves
+    static constexpr int SEE_PRUNE_MAX_DEPTH = 6;
+    static constexpr int SEE_CAPTURE_MARGIN = 100;
+    static constexpr int SEE_QUIET_MARGIN = 20;
+
+    // Quiescence search: plies searched before standing pat regardless, the TT depth of
+    // its entries (below every main search entry), and the delta pruning margin
+    static constexpr int QSEARCH_MAX_DEPTH = 16;
+    static constexpr int QSEARCH_TT_DEPTH = 0;
+    static constexpr int DELTA_MARGIN = 200;
+
+    // History scores stay within +-HISTORY_MAX
+    static constexpr int HISTORY_MAX = 16384;
+
+    // Quiet moves remembered per node, to be penalized when another one causes a cutoff
+    static constexpr int MAX_QUIETS_TRIED = 64;
+
+    struct SplitPoint;
+
+    // Search state owned by one thread. Nothing in here is shared.
+    struct SearchThread {
+        int id = 0;   // 0 is the main thread
 
-        int score;
+        // Arrays for move ordering heuristics.
+        // We'll use these to prioritize promising moves.
+        ButterflyHistory historyHeuristic{};
+        std::array<std::array<CompactMove, 2>, MAX_PLY + 1> killerMoves{};   // Two per ply
+        CounterMoveTable counterMoves{};
+        ContinuationHistory continuationHistory{};
+
+        // Pawn structure cache, kept from one search to the next
+        PawnTable pawnTable;
+
+        // Static evaluation at each ply of the current line, to tell whether the side to
+        // move is improving on its position two plies earlier
+        std::array<Value, MAX_PLY + 1> staticEvals{};
+
+        // Result of the last completed iteration
+        CompactMove bestMove;
+        Value bestScore = VALUE_ZERO;
+        int completedDepth = 0;
+        uint64_t nodes = 0;
+
+        // Nodes of the last root pass, in total and below its best move
+        uint64_t rootNodes = 0;
+        uint64_t bestMoveNodes = 0;
+        uint64_t splits = 0;
+
+        // Null moves are not tried above this ply while a null-move verification search runs
+        int nullMoveMinPly = 0;
+
+        // Innermost split point this thread is searching under (YBWC)
+        SplitPoint* splitPoint = nullptr;
+    };
+
+    // Siblings of a node shared between threads. The owner publishes it on its own
+    // queue; every thread that joins takes moves from it until none are left or a
+    // cutoff makes the rest pointless.
+    struct SplitPoint {
+        Board board;                    // Position at the node, copied by joining helpers
+        SplitPoint* parent;             // Split point the owner was itself searching under
+        MoveList moves;
+        std::atomic<size_t> nextMove;
         int depth;
-        Move bestMove;
-        BoundType bound;
+        int ply;
+        bool pvNode;
+        bool improving;
+        Value staticEvals[2];           // Owner's staticEvals at ply - 1 and ply
+
+        std::mutex mutex;               // Guards the fields below
+        Value alpha;
+        Value beta;
+        Value score;
+        CompactMove bestMove;
+        int legalMoves;
+        std::array<CompactMove, MAX_QUIETS_TRIED> quietsTried;
+        int quietCount;
+
+        std::atomic<bool> cutoff;
+        std::atomic<int> activeThreads;
     };
 
-private:
-    std::chrono::milliseconds timeLimit;
-    std::chrono::steady_clock::time_point startTime;
+    // Split points published by one thread, oldest (shallowest) at the front
+    struct SplitQueue {
+        std::mutex mutex;
+        std::deque<SplitPoint*> splitPoints;
+    };
+
+    // Nodes the main thread searches between two reads of the clock (a power of two)
+    static constexpr uint64_t TIME_CHECK_NODES = 1024;
+
+    // How often the main thread reads the clock while it sleeps waiting for its helpers
+    static constexpr std::chrono::milliseconds IDLE_TIME_CHECK{1};
+
+    // Minimum remaining depth worth sharing between threads
+    static constexpr int YBWC_MIN_SPLIT_DEPTH = 3;
+
+    TimeManager timeManager;
+
+    // The transposition table for position caching, fixed in size for the engine's lifetime.
+    TranspositionTable transpositionTable;
 
-    // The transposition table for position caching.
-    std::unordered_map<uint64_t, TranspositionEntry> transpositionTable;
+    std::vector<SearchThread> threads;
+    std::atomic<bool> stopSearch;
 
-    // The Zobrist hash key for the current board state.
-    ZobristHash zobrist;
+    ParallelMode parallelMode;
+    EvalType evalType;
+    int depthLimit;
+    size_t pawnTableEntries;   // Per thread
+    std::unique_ptr<SplitQueue[]> splitQueues;
+    std::atomic<int> idleThreads;
 
-    // Arrays for move ordering heuristics.
-    // We'll use these to prioritize promising moves.
-    std::array<std::array<int, BOARD_SIZE>, BOARD_SIZE> historyHeuristic;
-    std::array<std::array<Move, BOARD_SIZE>, BOARD_SIZE> killerMoves;
+    // YBWC threads with nothing to search sleep on idleCondition: helpers until a split
+    // point is published, owners until their split point empties. Both events, and the
+    // end of the search, are signalled under idleMutex so no sleeper can miss them.
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+    std::atomic<uint64_t> splitGeneration;   // Split points published so far
+    SearchStats lastStats;
 
-    // The core recursive function for the Minimax search with alpha-beta pruning.
-    int alphaBeta(Board& board, int depth, int alpha, int beta);
+    // Iterative deepening loop run by every search thread.
+    void iterativeDeepening(Board& board, SearchThread& thread);
 
-    // This is the move ordering function that prioritizes promising moves.
-    std::vector<Move> orderMoves(const Board& board, const std::vector<Move>& moves);
+    // One pass over the root moves within (alpha, beta). Returns false if time ran out.
+    bool searchRoot(SearchThread& thread, Board& board, const MoveList& moves, int depth,
+                    Value alpha, Value beta, Value& bestScore, CompactMove& bestMove);
 
-    // Checks if the time limit for the search has been exceeded.
-    bool timeIsUp() const;
+    // The core recursive negamax search with alpha-beta pruning. ply is the distance from the root.
+    Value alphaBeta(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta);
 
-    // Quiescence search to handle noisy positions at the end of the search.
-    int quiescenceSearch(Board& board, int alpha, int beta);
+    // Searches a child already made on board with a null window, first at reduced depth if
+    // reduction > 0, then at full depth and finally with the full window if it beats alpha.
+    Value searchLateMove(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta, int reduction);
+
+    // Late move reduction for the moveNumber-th move searched at a node of the given depth
+    static int lateMoveReduction(int depth, int moveNumber);
+
+    // Shallow pruning of a legal move, decided before it is made, for alphaBeta and split
+    // points alike. Only for moves that do not give check, at nodes not in check that have
+    // a score to fall back on. Sets lateMove when every remaining quiet move can go too.
+    static bool pruneMove(const Board& board, CompactMove move, bool quiet, int depth, bool improving,
+                          Value staticEval, Value alpha, int quietCount, bool& lateMove);
+
+    // Continuation tables of the moves one and two plies back, null where there is none
+    static void continuationTables(SearchThread& thread, const Board& board, PieceToHistory* tables[2]);
+
+    // Rewards a quiet move that caused a cutoff in every quiet heuristic, and penalizes
+    // the quiets tried before it
+    static void updateQuietStats(SearchThread& thread, const Board& board, int ply, CompactMove best,
+                                 const CompactMove* quiets, int quietCount, int depth);
+
+    // Orders the root moves; interior nodes use a MovePicker instead.
+    void orderMoves(const SearchThread& thread, const Board& board, MoveList& moves, CompactMove ttMove);
+
+    // Picks the move to play from the threads' results.
+    const SearchThread& voteBestThread() const;
+
+    // YBWC backend: the helpers' idle loop, publishing a node's remaining moves, and
+    // searching the moves of a split point (by its owner or by a helper). An owner whose
+    // moves are all taken helps with split points below its own until its helpers are done.
+    void splitPointWorker(SearchThread& thread);
+    bool canSplit(int depth) const;
+    void split(SearchThread& thread, Board& board, const MoveList& moves, size_t firstMove, int depth, int ply,
+               bool pvNode, bool improving, Value& alpha, Value beta, Value& bestScore, CompactMove& bestMove,
+               int& legalMoves, CompactMove* quietsTried, int& quietCount);
+    void searchSplitPoint(SearchThread& thread, SplitPoint& splitPoint, Board& board);
+    SplitPoint* stealSplitPoint(const SearchThread& thread, const SplitPoint* within = nullptr);
+    void wakeIdleThreads(bool published);
+    static bool cutoffAbove(const SearchThread& thread);
+
+    // Main thread only: reads the clock and raises stopSearch once the hard time limit is reached.
+    void checkTime();
+
+    // Counts a node and tells whether the search has to unwind. Only the main thread
+    // reads the clock, once every TIME_CHECK_NODES of its nodes.
+    bool visitNode(SearchThread& thread);
+
+    // True once the search was stopped. Scores returned while unwinding are meaningless:
+    // they must never be stored in the TT or replace a completed iteration's result.
+    bool stopped() const { return stopSearch.load(std::memory_order_relaxed); }
+
+    // Quiescence search to handle noisy positions at the end of the search. depth is 0
+    // on entry and counts down with every capture.
+    Value quiescenceSearch(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta);
+
+    // Mate scores are stored in the TT relative to the node rather than the root
+    static Value scoreToTT(Value score, int ply);
+    static Value scoreFromTT(Value score, int ply);
 
 public:
     /**
      * @brief Constructor for the Engine.
+     *
+     * @param hashSizeMB Memory budget for the transposition table, in megabytes.
+     * @param threadCount Number of search threads, including the calling one.
+     */
+    explicit Engine(size_t hashSizeMB = TranspositionTable::DEFAULT_SIZE_MB, int threadCount = 1);
+
+    /**
+     * @brief Sets the number of search threads used by findBestMove (at least 1).
+     */
+    void setThreads(int threadCount);
+    int getThreads() const { return static_cast<int>(threads.size()); }
+
+    /**
+     * @brief Selects how extra threads are used. Has no effect with a single thread.
+     */
+    void setParallelMode(ParallelMode mode) { parallelMode = mode; }
+    ParallelMode getParallelMode() const { return parallelMode; }
+
+    /**
+     * @brief Selects the static evaluation. Networks are loaded with NNUE::LoadNetwork.
+     */
+    void setEvalType(EvalType type) { evalType = type; }
+    EvalType getEvalType() const { return evalType; }
+
+    /**
+     * @brief Caps the iterative deepening depth; 0 restores the default maximum.
+     */
+    void setDepthLimit(int depth) { depthLimit = depth; }
+
+    /**
+     * @brief Statistics of the last findBestMove call.
+     */
+    const SearchStats& getLastSearchStats() const { return lastStats; }
+
+    /**
+     * @brief Reallocates the transposition table, discarding its contents.
+     */
+    void setHashSize(size_t hashSizeMB) { transpositionTable.Resize(hashSizeMB); }
+
+    /**
+     * @brief Reallocates every thread's pawn hash table to about entries slots
+     *        (rounded down to a power of two), discarding their contents.
      */
-    Engine();
+    void setPawnTableSize(size_t entries);
 
     /**
      * @brief Finds the best move for the current position.
@@ -72,7 +318,7 @@ public:
      * @param timeControl The time control settings for time management.
      * @return The best move found, or an invalid move if no legal moves exist.
      */
-    Move findBestMove(Board board, Difficulty difficulty, const TimeControl& timeControl);
+    Move findBestMove(const Board& board, Difficulty difficulty, const TimeControl& timeControl);
 };
 
 } // namespace Chess
\ No newline at end of file
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "core/Board.h"
+#include "core/MoveList.h"
+#include "core/Types.h"
+#include <array>
+#include <cstdint>
+
+namespace Chess {
+
+// Colored piece index for history tables: PieceType within each color's block
+constexpr int PIECE_NB = COLOR_NB * PIECE_TYPE_NB;
+inline int PieceIndex(const Piece& piece) {
+    return ColorIndex(piece.color) * PIECE_TYPE_NB + static_cast<int>(piece.type);
+}
+
+// How often a quiet move caused a cutoff, by side to move, from square and to square
+using ButterflyHistory = std::array<std::array<std::array<int, SQUARE_NB>, SQUARE_NB>, COLOR_NB>;
+
+// Scores by moved piece and destination square
+using PieceToHistory = std::array<std::array<int16_t, SQUARE_NB>, PIECE_NB>;
+
+// How a quiet move did after a given earlier move, indexed by that move's piece and destination
+using ContinuationHistory = std::array<std::array<PieceToHistory, SQUARE_NB>, PIECE_NB>;
+
+// The quiet move that last refuted a move, indexed by that move's piece and destination
+using CounterMoveTable = std::array<std::array<CompactMove, SQUARE_NB>, PIECE_NB>;
+
+/**
+ * @class MovePicker
+ * @brief Hands out the moves of a node one at a time, most promising first.
+ *
+ * Moves are produced in stages and each stage is only generated once the previous
+ * one is exhausted: the TT move, captures that do not lose material by SEE in
+ * MVV-LVA order, the two killers, the counter move, quiet moves by history, and
+ * finally the losing captures. In check, the TT move is followed by all evasions.
+ * Within a stage the next move is found by selection, so a cutoff on an early move
+ * never pays for sorting the rest.
+ *
+ * Moves are pseudo-legal; the caller still has to test IsLegal.
+ */
+class MovePicker {
+public:
+    /**
+     * @param killers The two killer moves of this ply.
+     * @param contHistory Continuation tables for the moves one and two plies back, or null.
+     */
+    MovePicker(const Board& board, CompactMove ttMove, const CompactMove* killers, CompactMove counterMove,
+               const ButterflyHistory& history, const PieceToHistory* const* contHistory);
+
+    // Quiescence search: the TT move if it is noisy, then captures and promotions by
+    // MVV-LVA. In check, all evasions as in the main search.
+    MovePicker(const Board& board, CompactMove ttMove, const ButterflyHistory& history);
+
+    // Next move, or an invalid move once every stage is exhausted
+    CompactMove NextMove();
+
+    // Drops the quiet moves not handed out yet; captures still follow
+    void SkipQuiets() { skipQuiets = true; }
+
+private:
+    enum class Stage : uint8_t {
+        MAIN_TT, CAPTURE_INIT, GOOD_CAPTURE, REFUTATION, QUIET_INIT, QUIET, BAD_CAPTURE,
+        EVASION_TT, EVASION_INIT, EVASION,
+        QSEARCH_TT, QCAPTURE_INIT, QCAPTURE,
+        DONE
+    };
+
+    void ScoreCaptures();
+    void ScoreQuiets();
+    void ScoreEvasions();
+
+    // Swaps the best scored move from current onwards into current and returns it
+    CompactMove SelectBest();
+
+    bool IsRefutation(CompactMove move) const;
+
+    const Board& board;
+    const ButterflyHistory& history;
+    const PieceToHistory* contHistory[2];
+
+    Stage stage;
+    CompactMove ttMove;
+    std::array<CompactMove, 3> refutations;   // Killers, then the counter move
+    size_t refutationIndex;
+    bool skipQuiets;
+
+    MoveList moves;
+    std::array<int, MAX_MOVES> scores;
+    size_t current;
+
+    MoveList badCaptures;
+    size_t badCaptureIndex;
+};
+
+} // namespace Chess
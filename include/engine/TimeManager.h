@@ -0,0 +1,65 @@
+#pragma once
+
+#include "core/Types.h"
+#include <chrono>
+
+namespace Chess {
+
+/**
+ * @class TimeManager
+ * @brief Decides how long one move may think, from the side to move's clock.
+ *
+ * Two limits are derived when a search starts. The hard limit is never exceeded:
+ * the search is stopped mid-iteration when it is reached. The soft limit is the
+ * time the move should normally take; it is checked between iterations and
+ * stretched or shrunk by how settled the search looks. A root best move that
+ * keeps changing, a falling score, or a best move that took only a small share of
+ * the root nodes all buy more time. An iteration that would not finish before the
+ * hard limit is not started at all, since an unfinished iteration is thrown away.
+ */
+class TimeManager {
+public:
+    // Reserve per move for GUI and thread start-up latency
+    static constexpr std::chrono::milliseconds MOVE_OVERHEAD{ 30 };
+
+    // Moves the remaining time is spread over when the time control does not say
+    static constexpr int DEFAULT_MOVES_TO_GO = 40;
+
+    // Soft limit per move when the clock is not set (no time limit), and the least a
+    // timed move thinks unless half the remaining clock is less still
+    static constexpr std::chrono::milliseconds UNTIMED_MOVE_TIME{ 1000 };
+    static constexpr std::chrono::milliseconds MIN_THINK_TIME{ 100 };
+
+    /**
+     * @brief Starts the clock for a new move and computes its limits.
+     *
+     * Uses remainingTime if set, otherwise the time control's base time. With neither
+     * set the move is untimed and gets UNTIMED_MOVE_TIME.
+     */
+    void Init(const TimeControl& timeControl);
+
+    std::chrono::milliseconds Elapsed() const;
+    std::chrono::milliseconds SoftLimit() const { return softLimit; }
+    std::chrono::milliseconds HardLimit() const { return hardLimit; }
+
+    /**
+     * @brief Records a completed iteration and tells whether to start the next one.
+     *
+     * @param bestMoveChanged Whether the root best move differs from the previous iteration's.
+     * @param score The iteration's score, side to move relative.
+     * @param bestMoveNodeShare Fraction of the iteration's root nodes spent on the best move.
+     */
+    bool ShouldStopAfterIteration(bool bestMoveChanged, Value score, double bestMoveNodeShare);
+
+private:
+    std::chrono::steady_clock::time_point startTime;
+    std::chrono::milliseconds softLimit{ 0 };
+    std::chrono::milliseconds hardLimit{ 0 };
+
+    int iterations = 0;
+    int stableIterations = 0;              // Consecutive iterations with the same best move
+    Value previousScore = VALUE_ZERO;
+    std::chrono::milliseconds previousIterationEnd{ 0 };
+};
+
+} // namespace Chess
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "core/Types.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace Chess {
+
+// How a stored score relates to the true value of the position
+enum class BoundType : uint8_t { NONE = 0, UPPERBOUND = 1, LOWERBOUND = 2, EXACT = 3 };
+
+/**
+ * @struct TTEntry
+ * @brief One 8-byte transposition table slot.
+ *
+ * Only the top 16 bits of the position key are kept; the low bits already
+ * selected the cluster, so the pair identifies the position with a small
+ * chance of a false match. Callers must therefore treat the move as a hint
+ * and only play it if it is in the position's own move list.
+ */
+struct TTEntry {
+    uint16_t key16;
+    uint16_t move;       // CompactMove::Raw()
+    int16_t score;
+    int8_t depth;
+    uint8_t genBound;    // Generation in the high 6 bits, BoundType in the low 2
+
+    CompactMove Move() const { return CompactMove(move); }
+    Value Score() const { return score; }
+    int Depth() const { return depth; }
+    BoundType Bound() const { return static_cast<BoundType>(genBound & 0x3); }
+    uint8_t Generation() const { return genBound & 0xFC; }
+    bool IsEmpty() const { return Bound() == BoundType::NONE; }
+};
+
+/**
+ * @class TranspositionTable
+ * @brief Fixed-size hash table of search results.
+ *
+ * Memory is allocated once for the configured budget and never grows. Entries
+ * are grouped into clusters that fill exactly one 64-byte cache line, so a
+ * probe touches a single line. When a cluster is full, the shallowest entry
+ * from the oldest search is replaced.
+ *
+ * The table is shared by all search threads without locking. Each entry is
+ * read and written as a single 64-bit atomic word, so a probe never sees half
+ * of one store and half of another.
+ */
+class TranspositionTable {
+public:
+    static constexpr size_t DEFAULT_SIZE_MB = 16;
+    static constexpr int CLUSTER_SIZE = 8;
+
+    explicit TranspositionTable(size_t sizeMB = DEFAULT_SIZE_MB);
+
+    // Reallocates to the largest power-of-two cluster count that fits in sizeMB. Clears the table.
+    void Resize(size_t sizeMB);
+    void Clear();
+
+    // Starts a new search, ageing every entry stored so far
+    void NewSearch() { generation += GENERATION_STEP; }
+
+    // Copies the entry for key into entry, false if the position is not stored
+    bool Probe(uint64_t key, TTEntry& entry) const;
+    void Store(uint64_t key, Value score, int depth, BoundType bound, CompactMove move);
+
+    // Starts loading key's cluster into cache, so a later Probe does not stall on memory
+    void Prefetch(uint64_t key) const;
+
+    // Permille of sampled entries written during the current search
+    int Hashfull() const;
+
+private:
+    struct alignas(64) Cluster {
+        std::atomic<uint64_t> entries[CLUSTER_SIZE];
+    };
+    static_assert(sizeof(Cluster) == 64, "a cluster must fill exactly one cache line");
+    static_assert(sizeof(TTEntry) == sizeof(uint64_t), "an entry must pack into one atomic word");
+    static_assert(VALUE_INFINITE <= INT16_MAX, "every score must fit the 16-bit entry field");
+
+    static constexpr uint8_t GENERATION_STEP = 4;   // Keeps the low 2 bound bits free
+
+    static TTEntry Load(const std::atomic<uint64_t>& slot);
+    static void Save(std::atomic<uint64_t>& slot, const TTEntry& entry);
+
+    Cluster& ClusterFor(uint64_t key) { return table[key & clusterMask]; }
+    const Cluster& ClusterFor(uint64_t key) const { return table[key & clusterMask]; }
+
+    std::unique_ptr<Cluster[]> table;
+    size_t clusterCount;
+    uint64_t clusterMask;
+    uint8_t generation;
+};
+
+} // namespace Chess
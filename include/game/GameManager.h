@@ -109,7 +109,7 @@ public:
     bool IsValidMove(const Move& move) const { return IsLegalMove(move); }
 
     // Game analysis
-    float GetCurrentEvaluation() const;
+    Value GetCurrentEvaluation() const;   // White-relative
     std::string GetGamePGN() const;
     std::string GetCurrentFEN() const;
     const GameStats& GetGameStats() const { return gameStats; }
@@ -0,0 +1,205 @@
+#include "core/Bitboard.h"
+#include <sstream>
+
+namespace Chess {
+namespace Bitboards {
+
+std::array<std::array<Bitboard, SQUARE_NB>, COLOR_NB> PawnAttacks;
+std::array<Bitboard, SQUARE_NB> KnightAttacks;
+std::array<Bitboard, SQUARE_NB> KingAttacks;
+
+std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> Between;
+std::array<std::array<Bitboard, SQUARE_NB>, SQUARE_NB> Line;
+
+bool UsePext = false;
+std::array<Magic, SQUARE_NB> RookMagics;
+std::array<Magic, SQUARE_NB> BishopMagics;
+
+namespace {
+
+// Returns the bit for (x, y) if it is on the board, 0 otherwise.
+Bitboard SafeSquare(int x, int y) {
+    return (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE) ? SquareBB(MakeSquare(x, y)) : 0;
+}
+
+Bitboard SlidingAttacks(int sq, Bitboard occupied, const int (&dirs)[4][2]) {
+    Bitboard attacks = 0;
+    for (const auto& dir : dirs) {
+        int x = SquareFile(sq) + dir[0];
+        int y = SquareRow(sq) + dir[1];
+        while (x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE) {
+            Bitboard b = SquareBB(MakeSquare(x, y));
+            attacks |= b;
+            if (occupied & b) break;
+            x += dir[0];
+            y += dir[1];
+        }
+    }
+    return attacks;
+}
+
+constexpr int ROOK_DIRECTIONS[4][2] = { {-1, 0}, {1, 0}, {0, -1}, {0, 1} };
+constexpr int BISHOP_DIRECTIONS[4][2] = { {-1, -1}, {-1, 1}, {1, -1}, {1, 1} };
+
+// Shared storage for every square's attack slice
+std::array<Bitboard, 0x19000> RookTable;   // 102400 entries
+std::array<Bitboard, 0x1480> BishopTable;  // 5248 entries
+
+bool CpuHasBmi2() {
+#if CHESS_HAS_PEXT && defined(_MSC_VER)
+    int info[4];
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 8)) != 0;
+#elif CHESS_HAS_PEXT
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("bmi2");
+#else
+    return false;
+#endif
+}
+
+// xorshift64* with a fixed seed, so magic search is reproducible and fast.
+class MagicRng {
+public:
+    explicit MagicRng(uint64_t seed) : state(seed) {}
+
+    uint64_t Next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 2685821657736338717ULL;
+    }
+
+    // Magics with few set bits are found much faster
+    uint64_t Sparse() { return Next() & Next() & Next(); }
+
+private:
+    uint64_t state;
+};
+
+// Fills the magic entries and attack table for one slider type. Every occupancy subset of
+// each square's mask is enumerated with the Carry-Rippler trick; with PEXT the subsets map
+// straight to their index, otherwise random sparse multipliers are tried until one maps all
+// subsets without a destructive collision.
+void InitSliderTables(std::array<Magic, SQUARE_NB>& magics, Bitboard* table,
+                      Bitboard (*slowAttacks)(int, Bitboard)) {
+    std::array<Bitboard, 4096> occupancy;
+    std::array<Bitboard, 4096> reference;
+    std::array<int, 4096> epoch = {};
+    int attempt = 0;
+    MagicRng rng(0x9E3779B97F4A7C15ULL);
+
+    for (int sq = 0; sq < SQUARE_NB; ++sq) {
+        Bitboard edges = ((ROW_0_BB | ROW_7_BB) & ~RowBB(SquareRow(sq)))
+                       | ((FILE_A_BB | FILE_H_BB) & ~FileBB(SquareFile(sq)));
+
+        Magic& m = magics[sq];
+        m.mask = slowAttacks(sq, 0) & ~edges;
+        m.shift = 64 - PopCount(m.mask);
+        m.attacks = (sq == 0) ? table : magics[sq - 1].attacks + (1u << (64 - magics[sq - 1].shift));
+
+        int size = 0;
+        Bitboard b = 0;
+        do {
+            occupancy[size] = b;
+            reference[size] = slowAttacks(sq, b);
+            if (UsePext) {
+                m.attacks[m.Index(b)] = reference[size];
+            }
+            ++size;
+            b = (b - m.mask) & m.mask;
+        } while (b);
+
+        if (UsePext) continue;
+
+        for (int i = 0; i < size;) {
+            do {
+                m.magic = rng.Sparse();
+            } while (PopCount((m.magic * m.mask) >> 56) < 6);
+
+            ++attempt;
+            for (i = 0; i < size; ++i) {
+                unsigned idx = m.Index(occupancy[i]);
+                if (epoch[idx] < attempt) {
+                    epoch[idx] = attempt;
+                    m.attacks[idx] = reference[i];
+                } else if (m.attacks[idx] != reference[i]) {
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void Init() {
+    const int knightOffsets[8][2] = { {-2, -1}, {-2, 1}, {-1, -2}, {-1, 2}, {1, -2}, {1, 2}, {2, -1}, {2, 1} };
+
+    for (int sq = 0; sq < SQUARE_NB; ++sq) {
+        int x = SquareFile(sq), y = SquareRow(sq);
+
+        // White pawns move towards row 0, black pawns towards row 7
+        PawnAttacks[ColorIndex(Color::WHITE)][sq] = SafeSquare(x - 1, y - 1) | SafeSquare(x + 1, y - 1);
+        PawnAttacks[ColorIndex(Color::BLACK)][sq] = SafeSquare(x - 1, y + 1) | SafeSquare(x + 1, y + 1);
+
+        KnightAttacks[sq] = 0;
+        for (const auto& offset : knightOffsets) {
+            KnightAttacks[sq] |= SafeSquare(x + offset[0], y + offset[1]);
+        }
+
+        KingAttacks[sq] = 0;
+        for (int dx = -1; dx <= 1; ++dx) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                if (dx != 0 || dy != 0) KingAttacks[sq] |= SafeSquare(x + dx, y + dy);
+            }
+        }
+    }
+
+    UsePext = CpuHasBmi2();
+    InitSliderTables(RookMagics, RookTable.data(), RookAttacksSlow);
+    InitSliderTables(BishopMagics, BishopTable.data(), BishopAttacksSlow);
+
+    for (int a = 0; a < SQUARE_NB; ++a) {
+        for (int b = 0; b < SQUARE_NB; ++b) {
+            Between[a][b] = Line[a][b] = 0;
+            if (a == b) continue;
+
+            Bitboard bbA = SquareBB(a), bbB = SquareBB(b);
+            if (RookAttacksSlow(a, 0) & bbB) {
+                Between[a][b] = RookAttacksSlow(a, bbB) & RookAttacksSlow(b, bbA);
+                Line[a][b] = (RookAttacksSlow(a, 0) & RookAttacksSlow(b, 0)) | bbA | bbB;
+            } else if (BishopAttacksSlow(a, 0) & bbB) {
+                Between[a][b] = BishopAttacksSlow(a, bbB) & BishopAttacksSlow(b, bbA);
+                Line[a][b] = (BishopAttacksSlow(a, 0) & BishopAttacksSlow(b, 0)) | bbA | bbB;
+            }
+        }
+    }
+}
+
+// Tables are filled during static initialization so every Board can rely on them.
+struct Initializer {
+    Initializer() { Init(); }
+} initializer;
+
+} // namespace
+
+Bitboard RookAttacksSlow(int sq, Bitboard occupied) {
+    return SlidingAttacks(sq, occupied, ROOK_DIRECTIONS);
+}
+
+Bitboard BishopAttacksSlow(int sq, Bitboard occupied) {
+    return SlidingAttacks(sq, occupied, BISHOP_DIRECTIONS);
+}
+
+std::string ToString(Bitboard b) {
+    std::ostringstream ss;
+    for (int y = 0; y < BOARD_SIZE; ++y) {
+        for (int x = 0; x < BOARD_SIZE; ++x) {
+            ss << ((b & SquareBB(MakeSquare(x, y))) ? 'X' : '.');
+        }
+        ss << '\n';
+    }
+    return ss.str();
+}
+
+} // namespace Bitboards
+} // namespace Chess
@@ -1,88 +1,30 @@
 #include "core/Board.h"
+#include "core/ZobristHash.h"
 #include <fmt/format.h>
 #include <sstream>
 #include <algorithm>
+#include <cassert>
 #include <unordered_set>
 
 namespace Chess {
 
-// Piece-square tables for position evaluation (from white's perspective)
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::PAWN_TABLE = {{
-    {{ 0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0}},
-    {{ 5.0,  5.0,  5.0,  5.0,  5.0,  5.0,  5.0,  5.0}},
-    {{ 1.0,  1.0,  2.0,  3.0,  3.0,  2.0,  1.0,  1.0}},
-    {{ 0.5,  0.5,  1.0,  2.5,  2.5,  1.0,  0.5,  0.5}},
-    {{ 0.0,  0.0,  0.0,  2.0,  2.0,  0.0,  0.0,  0.0}},
-    {{ 0.5, -0.5, -1.0,  0.0,  0.0, -1.0, -0.5,  0.5}},
-    {{ 0.5,  1.0,  1.0, -2.0, -2.0,  1.0,  1.0,  0.5}},
-    {{ 0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0}}
-}};
-
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::KNIGHT_TABLE = {{
-    {{-5.0, -4.0, -3.0, -3.0, -3.0, -3.0, -4.0, -5.0}},
-    {{-4.0, -2.0,  0.0,  0.0,  0.0,  0.0, -2.0, -4.0}},
-    {{-3.0,  0.0,  1.0,  1.5,  1.5,  1.0,  0.0, -3.0}},
-    {{-3.0,  0.5,  1.5,  2.0,  2.0,  1.5,  0.5, -3.0}},
-    {{-3.0,  0.0,  1.5,  2.0,  2.0,  1.5,  0.0, -3.0}},
-    {{-3.0,  0.5,  1.0,  1.5,  1.5,  1.0,  0.5, -3.0}},
-    {{-4.0, -2.0,  0.0,  0.5,  0.5,  0.0, -2.0, -4.0}},
-    {{-5.0, -4.0, -3.0, -3.0, -3.0, -3.0, -4.0, -5.0}}
-}};
-
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::BISHOP_TABLE = {{
-    {{-2.0, -1.0, -1.0, -1.0, -1.0, -1.0, -1.0, -2.0}},
-    {{-1.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -1.0}},
-    {{-1.0,  0.0,  0.5,  1.0,  1.0,  0.5,  0.0, -1.0}},
-    {{-1.0,  0.5,  0.5,  1.0,  1.0,  0.5,  0.5, -1.0}},
-    {{-1.0,  0.0,  1.0,  1.0,  1.0,  1.0,  0.0, -1.0}},
-    {{-1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0, -1.0}},
-    {{-1.0,  0.5,  0.0,  0.0,  0.0,  0.0,  0.5, -1.0}},
-    {{-2.0, -1.0, -1.0, -1.0, -1.0, -1.0, -1.0, -2.0}}
-}};
-
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::ROOK_TABLE = {{
-    {{ 0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0}},
-    {{ 0.5,  1.0,  1.0,  1.0,  1.0,  1.0,  1.0,  0.5}},
-    {{-0.5,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -0.5}},
-    {{-0.5,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -0.5}},
-    {{-0.5,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -0.5}},
-    {{-0.5,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -0.5}},
-    {{-0.5,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -0.5}},
-    {{ 0.0,  0.0,  0.0,  0.5,  0.5,  0.0,  0.0,  0.0}}
-}};
-
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::QUEEN_TABLE = {{
-    {{-2.0, -1.0, -1.0, -0.5, -0.5, -1.0, -1.0, -2.0}},
-    {{-1.0,  0.0,  0.0,  0.0,  0.0,  0.0,  0.0, -1.0}},
-    {{-1.0,  0.0,  0.5,  0.5,  0.5,  0.5,  0.0, -1.0}},
-    {{-0.5,  0.0,  0.5,  0.5,  0.5,  0.5,  0.0, -0.5}},
-    {{ 0.0,  0.0,  0.5,  0.5,  0.5,  0.5,  0.0, -0.5}},
-    {{-1.0,  0.5,  0.5,  0.5,  0.5,  0.5,  0.0, -1.0}},
-    {{-1.0,  0.0,  0.5,  0.0,  0.0,  0.0,  0.0, -1.0}},
-    {{-2.0, -1.0, -1.0, -0.5, -0.5, -1.0, -1.0, -2.0}}
-}};
-
-const std::array<std::array<float, BOARD_SIZE>, BOARD_SIZE> Board::KING_TABLE = {{
-    {{-3.0, -4.0, -4.0, -5.0, -5.0, -4.0, -4.0, -3.0}},
-    {{-3.0, -4.0, -4.0, -5.0, -5.0, -4.0, -4.0, -3.0}},
-    {{-3.0, -4.0, -4.0, -5.0, -5.0, -4.0, -4.0, -3.0}},
-    {{-3.0, -4.0, -4.0, -5.0, -5.0, -4.0, -4.0, -3.0}},
-    {{-2.0, -3.0, -3.0, -4.0, -4.0, -3.0, -3.0, -2.0}},
-    {{-1.0, -2.0, -2.0, -2.0, -2.0, -2.0, -2.0, -1.0}},
-    {{ 2.0,  2.0,  0.0,  0.0,  0.0,  0.0,  2.0,  2.0}},
-    {{ 2.0,  3.0,  1.0,  0.0,  0.0,  1.0,  3.0,  2.0}}
-}};
-
 Board::Board()
     : currentPlayer(Color::WHITE),
-    whiteKingSideCastle(false),
-    whiteQueenSideCastle(false),
-    blackKingSideCastle(false),
-    blackQueenSideCastle(false),
+    castlingRights(0),
     enPassantTarget(),
     halfMoveClock(0),
-    fullMoveNumber(1)
+    fullMoveNumber(1),
+    pliesFromNull(0),
+    key(0),
+    pawnKey(0),
+    materialKey(0),
+    gamePhase(0),
+    nnueEnabled(false),
+    stateCount(0)
 {
+    checkersBB = 0;
+    blockersForKing.fill(0);
+    checkSquares.fill(0);
     // Initialize the board array to empty
     Clear();
 }
@@ -109,30 +51,40 @@ void Board::SetupStartingPosition() {
 
     // Set initial game state
     currentPlayer = Color::WHITE;
-    whiteKingSideCastle = whiteQueenSideCastle = true;
-    blackKingSideCastle = blackQueenSideCastle = true;
+    castlingRights = WHITE_KING_SIDE | WHITE_QUEEN_SIDE | BLACK_KING_SIDE | BLACK_QUEEN_SIDE;
     enPassantTarget = Position();
     halfMoveClock = 0;
     fullMoveNumber = 1;
 
-    AddToHistory();
+    SetCheckInfo();
+    SetKeys();
 }
 
 void Board::Clear() {
-    // Initialize all squares to empty
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            squares[y][x] = Piece();  // Empty piece
-        }
+    // Initialize all squares and bitboards to empty
+    mailbox.fill(Piece());
+    for (auto& colorPieces : pieceBB) {
+        colorPieces.fill(0);
     }
+    colorBB.fill(0);
+    occupiedBB = 0;
 
     currentPlayer = Color::WHITE;
-    whiteKingSideCastle = whiteQueenSideCastle = false;
-    blackKingSideCastle = blackQueenSideCastle = false;
+    castlingRights = 0;
     enPassantTarget = Position();
     halfMoveClock = 0;
     fullMoveNumber = 1;
-    positionHistory.clear();
+    stateStack.clear();
+    stateCount = 0;
+    pliesFromNull = 0;
+    checkersBB = 0;
+    blockersForKing.fill(0);
+    checkSquares.fill(0);
+    key = pawnKey = materialKey = 0;
+    psqt = Score();
+    gamePhase = 0;
+    accumulator.computed[0] = accumulator.computed[1] = false;
+    accumulatorStack.Clear();
 }
 
 const Piece& Board::GetPiece(const Position& pos) const {
@@ -144,7 +96,7 @@ const Piece& Board::GetPiece(int x, int y) const {
         static const Piece empty;
         return empty;
     }
-    return squares[y][x];
+    return mailbox[MakeSquare(x, y)];
 }
 
 void Board::SetPiece(const Position& pos, const Piece& piece) {
@@ -153,8 +105,136 @@ void Board::SetPiece(const Position& pos, const Piece& piece) {
 
 void Board::SetPiece(int x, int y, const Piece& piece) {
     if (IsValidPosition(x, y)) {
-        squares[y][x] = piece;
+        int sq = MakeSquare(x, y);
+        Piece newPiece = piece;  // piece may alias a mailbox entry
+        RemovePiece(sq);
+        if (!newPiece.IsEmpty()) {
+            PutPiece(sq, newPiece);
+        }
+        SetCheckInfo();
+        SetKeys();
+    }
+}
+
+void Board::SetCurrentPlayer(Color color) {
+    currentPlayer = color;
+    SetCheckInfo();
+    SetKeys();
+}
+
+void Board::SetEnPassantTarget(const Position& target) {
+    enPassantTarget = target;
+    SetKeys();
+}
+
+void Board::ClearEnPassantTarget() {
+    enPassantTarget = Position();
+    SetKeys();
+}
+
+void Board::SetKeys() {
+    key = ZobristHash::getHash(*this);
+    pawnKey = ZobristHash::getPawnHash(*this);
+    materialKey = ZobristHash::getMaterialHash(*this);
+}
+
+Bitboard Board::SliderBlockers(Bitboard sliders, int sq) const {
+    Bitboard blockers = 0;
+
+    // Sliders that would attack sq on an empty board
+    Bitboard snipers = ((RookAttacksFrom(sq, 0) & (Pieces(PieceType::ROOK) | Pieces(PieceType::QUEEN)))
+                      | (BishopAttacksFrom(sq, 0) & (Pieces(PieceType::BISHOP) | Pieces(PieceType::QUEEN)))) & sliders;
+
+    while (snipers) {
+        Bitboard between = BetweenBB(sq, PopLsb(snipers)) & occupiedBB;
+        if (between && !MoreThanOne(between)) {
+            blockers |= between;
+        }
     }
+    return blockers;
+}
+
+void Board::SetCheckInfo() {
+    checkersBB = 0;
+    for (Color color : { Color::WHITE, Color::BLACK }) {
+        Bitboard king = Pieces(color, PieceType::KING);
+        if (!king) {
+            blockersForKing[ColorIndex(color)] = 0;
+            continue;
+        }
+
+        int kingSq = Lsb(king);
+        blockersForKing[ColorIndex(color)] = SliderBlockers(Pieces(Opponent(color)), kingSq);
+        if (color == currentPlayer) {
+            checkersBB = AttackersTo(kingSq, occupiedBB) & Pieces(Opponent(color));
+        }
+    }
+    SetCheckSquares();
+}
+
+void Board::SetCheckSquares() {
+    checkSquares.fill(0);
+    Color them = Opponent(currentPlayer);
+    Bitboard king = Pieces(them, PieceType::KING);
+    if (!king) return;
+
+    int kingSq = Lsb(king);
+    checkSquares[static_cast<int>(PieceType::PAWN)] = PawnAttacksFrom(them, kingSq);
+    checkSquares[static_cast<int>(PieceType::KNIGHT)] = KnightAttacksFrom(kingSq);
+    checkSquares[static_cast<int>(PieceType::BISHOP)] = BishopAttacksFrom(kingSq, occupiedBB);
+    checkSquares[static_cast<int>(PieceType::ROOK)] = RookAttacksFrom(kingSq, occupiedBB);
+    checkSquares[static_cast<int>(PieceType::QUEEN)] = checkSquares[static_cast<int>(PieceType::BISHOP)]
+                                                     | checkSquares[static_cast<int>(PieceType::ROOK)];
+}
+
+void Board::PutPiece(int sq, const Piece& piece) {
+    Bitboard b = SquareBB(sq);
+    int c = ColorIndex(piece.color);
+    Bitboard& typeBB = pieceBB[c][static_cast<int>(piece.type)];
+
+    key ^= ZobristHash::PieceKey(piece.color, piece.type, sq);
+    if (piece.type == PieceType::PAWN) {
+        pawnKey ^= ZobristHash::PieceKey(piece.color, piece.type, sq);
+    }
+    // Material keys are indexed by piece count rather than square
+    materialKey ^= ZobristHash::PieceKey(piece.color, piece.type, PopCount(typeBB));
+
+    psqt += PSQT::PieceScore(piece.color, piece.type, sq);
+    gamePhase += PSQT::PhaseWeight(piece.type);
+    if (nnueEnabled) {
+        UpdateAccumulator(piece, sq, true);
+    }
+
+    mailbox[sq] = piece;
+    typeBB |= b;
+    colorBB[c] |= b;
+    occupiedBB |= b;
+}
+
+void Board::RemovePiece(int sq) {
+    const Piece& piece = mailbox[sq];
+    if (piece.IsEmpty()) return;
+
+    Bitboard b = SquareBB(sq);
+    int c = ColorIndex(piece.color);
+    Bitboard& typeBB = pieceBB[c][static_cast<int>(piece.type)];
+    typeBB &= ~b;
+
+    key ^= ZobristHash::PieceKey(piece.color, piece.type, sq);
+    if (piece.type == PieceType::PAWN) {
+        pawnKey ^= ZobristHash::PieceKey(piece.color, piece.type, sq);
+    }
+    materialKey ^= ZobristHash::PieceKey(piece.color, piece.type, PopCount(typeBB));
+
+    psqt -= PSQT::PieceScore(piece.color, piece.type, sq);
+    gamePhase -= PSQT::PhaseWeight(piece.type);
+    if (nnueEnabled) {
+        UpdateAccumulator(piece, sq, false);
+    }
+
+    colorBB[c] &= ~b;
+    occupiedBB &= ~b;
+    mailbox[sq] = Piece();
 }
 
 bool Board::IsEmpty(const Position& pos) const {
@@ -162,138 +242,154 @@ bool Board::IsEmpty(const Position& pos) const {
 }
 
 bool Board::CanCastleKingSide(Color color) const {
-    return color == Color::WHITE ? whiteKingSideCastle : blackKingSideCastle;
+    return castlingRights & (color == Color::WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE);
 }
 
 bool Board::CanCastleQueenSide(Color color) const {
-    return color == Color::WHITE ? whiteQueenSideCastle : blackQueenSideCastle;
+    return castlingRights & (color == Color::WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE);
 }
 
 void Board::SetCastlingRights(Color color, bool kingSide, bool queenSide) {
-    if (color == Color::WHITE) {
-        whiteKingSideCastle = kingSide;
-        whiteQueenSideCastle = queenSide;
-    } else {
-        blackKingSideCastle = kingSide;
-        blackQueenSideCastle = queenSide;
-    }
+    DisableCastling(color, true, true);
+    if (kingSide) castlingRights |= (color == Color::WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE);
+    if (queenSide) castlingRights |= (color == Color::WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE);
+    SetKeys();
 }
 
 void Board::DisableCastling(Color color, bool kingSide, bool queenSide) {
-    if (color == Color::WHITE) {
-        if (kingSide) whiteKingSideCastle = false;
-        if (queenSide) whiteQueenSideCastle = false;
-    } else {
-        if (kingSide) blackKingSideCastle = false;
-        if (queenSide) blackQueenSideCastle = false;
-    }
+    if (kingSide) castlingRights &= ~(color == Color::WHITE ? WHITE_KING_SIDE : BLACK_KING_SIDE);
+    if (queenSide) castlingRights &= ~(color == Color::WHITE ? WHITE_QUEEN_SIDE : BLACK_QUEEN_SIDE);
+    SetKeys();
 }
 
 Position Board::FindKing(Color color) const {
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            const Piece& piece = GetPiece(x, y);
-            if (piece.type == PieceType::KING && piece.color == color) {
-                return Position(x, y);
-            }
-        }
-    }
-    return Position(); // Invalid position if king not found
+    Bitboard king = Pieces(color, PieceType::KING);
+    return king ? SquareToPosition(Lsb(king)) : Position(); // Invalid position if king not found
 }
 
 bool Board::IsInCheck(Color color) const {
+    if (color == currentPlayer) return checkersBB != 0;
+
     Position kingPos = FindKing(color);
     if (!kingPos.IsValid()) return false;
 
-    Color enemyColor = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
-    return IsSquareAttacked(kingPos, enemyColor);
+    return IsSquareAttacked(kingPos, Opponent(color));
 }
 
-bool Board::IsSquareAttacked(const Position& pos, Color attackingColor) const {
-    // Check for pawn attacks
-    int pawnDirection = (attackingColor == Color::WHITE) ? -1 : 1;
-    Position pawnLeft(pos.x - 1, pos.y + pawnDirection);
-    Position pawnRight(pos.x + 1, pos.y + pawnDirection);
+Bitboard Board::AttackersTo(int sq, Bitboard occupied) const {
+    Bitboard rooksQueens = Pieces(PieceType::ROOK) | Pieces(PieceType::QUEEN);
+    Bitboard bishopsQueens = Pieces(PieceType::BISHOP) | Pieces(PieceType::QUEEN);
 
-    if (pawnLeft.IsValid() && GetPiece(pawnLeft).type == PieceType::PAWN &&
-        GetPiece(pawnLeft).color == attackingColor) {
-        return true;
-    }
-    if (pawnRight.IsValid() && GetPiece(pawnRight).type == PieceType::PAWN &&
-        GetPiece(pawnRight).color == attackingColor) {
-        return true;
-    }
+    return (PawnAttacksFrom(Color::BLACK, sq) & Pieces(Color::WHITE, PieceType::PAWN))
+         | (PawnAttacksFrom(Color::WHITE, sq) & Pieces(Color::BLACK, PieceType::PAWN))
+         | (KnightAttacksFrom(sq) & Pieces(PieceType::KNIGHT))
+         | (KingAttacksFrom(sq) & Pieces(PieceType::KING))
+         | (RookAttacksFrom(sq, occupied) & rooksQueens)
+         | (BishopAttacksFrom(sq, occupied) & bishopsQueens);
+}
 
-    // Check for knight attacks
-    const std::array<Position, 8> knightMoves = {
-        Position(-2, -1), Position(-2, 1), Position(-1, -2), Position(-1, 2),
-        Position(1, -2), Position(1, 2), Position(2, -1), Position(2, 1)
-    };
+namespace {
 
-    for (const auto& offset : knightMoves) {
-        Position checkPos(pos.x + offset.x, pos.y + offset.y);
-        if (checkPos.IsValid() && GetPiece(checkPos).type == PieceType::KNIGHT &&
-            GetPiece(checkPos).color == attackingColor) {
-            return true;
-        }
-    }
+// Exchange values by PieceType; the king never gets captured, so it is worth nothing here
+constexpr int SEE_VALUES[PIECE_TYPE_NB] = { 0, 100, 500, 320, 330, 900, 0 };
 
-    // Check for sliding piece attacks (rook, bishop, queen)
-    const std::array<Position, 8> directions = {
-        Position(-1, 0), Position(1, 0), Position(0, -1), Position(0, 1),  // Rook directions
-        Position(-1, -1), Position(-1, 1), Position(1, -1), Position(1, 1) // Bishop directions
-    };
+} // namespace
 
-    for (int i = 0; i < 8; ++i) {
-        const Position& dir = directions[i];
-        Position checkPos(pos.x + dir.x, pos.y + dir.y);
-
-        while (checkPos.IsValid()) {
-            const Piece& piece = GetPiece(checkPos);
-            if (!piece.IsEmpty()) {
-                if (piece.color == attackingColor) {
-                    // Check if this piece can attack in this direction
-                    if (piece.type == PieceType::QUEEN ||
-                        (piece.type == PieceType::ROOK && i < 4) ||
-                        (piece.type == PieceType::BISHOP && i >= 4)) {
-                        return true;
-                    }
-                }
-                break; // Piece blocks further movement
-            }
-            checkPos.x += dir.x;
-            checkPos.y += dir.y;
-        }
+/**
+ * Swap algorithm: swap holds what the side to move next stands to lose or gain
+ * relative to threshold. Each recapture uses the least valuable attacker, and
+ * removing it from occupied uncovers any slider x-raying through it.
+ */
+bool Board::SEE(CompactMove move, int threshold) const {
+    // Castling, en passant and promotions exchange nothing worth counting here
+    if (move.Type() != MoveType::NORMAL) {
+        return 0 >= threshold;
     }
 
-    // Check for king attacks (adjacent squares)
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            if (dx == 0 && dy == 0) continue;
-            Position checkPos(pos.x + dx, pos.y + dy);
-            if (checkPos.IsValid() && GetPiece(checkPos).type == PieceType::KING &&
-                GetPiece(checkPos).color == attackingColor) {
-                return true;
-            }
+    int from = move.From();
+    int to = move.To();
+
+    int swap = SEE_VALUES[static_cast<int>(mailbox[to].type)] - threshold;
+    if (swap < 0) return false;
+
+    swap = SEE_VALUES[static_cast<int>(mailbox[from].type)] - swap;
+    if (swap <= 0) return true;
+
+    Bitboard occupied = occupiedBB ^ SquareBB(from) ^ SquareBB(to);
+    Color stm = mailbox[from].color;
+    Bitboard attackers = AttackersTo(to, occupied);
+    Bitboard bishopsQueens = Pieces(PieceType::BISHOP) | Pieces(PieceType::QUEEN);
+    Bitboard rooksQueens = Pieces(PieceType::ROOK) | Pieces(PieceType::QUEEN);
+    bool result = true;
+
+    while (true) {
+        stm = Opponent(stm);
+        attackers &= occupied;
+        Bitboard stmAttackers = attackers & Pieces(stm);
+        if (!stmAttackers) break;
+
+        result = !result;
+
+        Bitboard bb;
+        if ((bb = stmAttackers & Pieces(PieceType::PAWN))) {
+            if ((swap = SEE_VALUES[static_cast<int>(PieceType::PAWN)] - swap) < result) break;
+            occupied ^= SquareBB(Lsb(bb));
+            attackers |= BishopAttacksFrom(to, occupied) & bishopsQueens;
+        } else if ((bb = stmAttackers & Pieces(PieceType::KNIGHT))) {
+            if ((swap = SEE_VALUES[static_cast<int>(PieceType::KNIGHT)] - swap) < result) break;
+            occupied ^= SquareBB(Lsb(bb));
+        } else if ((bb = stmAttackers & Pieces(PieceType::BISHOP))) {
+            if ((swap = SEE_VALUES[static_cast<int>(PieceType::BISHOP)] - swap) < result) break;
+            occupied ^= SquareBB(Lsb(bb));
+            attackers |= BishopAttacksFrom(to, occupied) & bishopsQueens;
+        } else if ((bb = stmAttackers & Pieces(PieceType::ROOK))) {
+            if ((swap = SEE_VALUES[static_cast<int>(PieceType::ROOK)] - swap) < result) break;
+            occupied ^= SquareBB(Lsb(bb));
+            attackers |= RookAttacksFrom(to, occupied) & rooksQueens;
+        } else if ((bb = stmAttackers & Pieces(PieceType::QUEEN))) {
+            if ((swap = SEE_VALUES[static_cast<int>(PieceType::QUEEN)] - swap) < result) break;
+            occupied ^= SquareBB(Lsb(bb));
+            attackers |= (BishopAttacksFrom(to, occupied) & bishopsQueens)
+                       | (RookAttacksFrom(to, occupied) & rooksQueens);
+        } else {
+            // The king can only recapture if the other side has no attacker left
+            return (attackers & ~Pieces(stm)) ? !result : result;
         }
     }
 
-    return false;
+    return result;
+}
+
+bool Board::IsSquareAttacked(const Position& pos, Color attackingColor) const {
+    if (!pos.IsValid()) return false;
+
+    int sq = PositionToSquare(pos);
+    int c = ColorIndex(attackingColor);
+    const auto& enemy = pieceBB[c];
+
+    // A pawn of the attacking color attacks sq exactly when a pawn of the
+    // other color standing on sq would attack it back.
+    if (PawnAttacksFrom(Opponent(attackingColor), sq) & enemy[static_cast<int>(PieceType::PAWN)]) return true;
+    if (KnightAttacksFrom(sq) & enemy[static_cast<int>(PieceType::KNIGHT)]) return true;
+    if (KingAttacksFrom(sq) & enemy[static_cast<int>(PieceType::KING)]) return true;
+
+    Bitboard queens = enemy[static_cast<int>(PieceType::QUEEN)];
+    Bitboard rooksQueens = enemy[static_cast<int>(PieceType::ROOK)] | queens;
+    if (rooksQueens && (RookAttacksFrom(sq, occupiedBB) & rooksQueens)) return true;
+
+    Bitboard bishopsQueens = enemy[static_cast<int>(PieceType::BISHOP)] | queens;
+    return bishopsQueens && (BishopAttacksFrom(sq, occupiedBB) & bishopsQueens);
 }
 
 std::vector<Move> Board::GetAllLegalMoves(Color color) const {
-    std::vector<Move> legalMoves;
+    MoveList moves;
+    GenerateMoves(GenType::LEGAL, moves, color);
 
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            const Piece& piece = GetPiece(x, y);
-            if (piece.color == color) {
-                auto pieceMoves = GetPieceMoves(Position(x, y));
-                legalMoves.insert(legalMoves.end(), pieceMoves.begin(), pieceMoves.end());
-            }
-        }
+    std::vector<Move> legalMoves;
+    legalMoves.reserve(moves.Size());
+    for (CompactMove move : moves) {
+        legalMoves.push_back(ToMove(move));
     }
-
     return legalMoves;
 }
 
@@ -301,249 +397,302 @@ std::vector<Move> Board::GetPieceMoves(const Position& pos) const {
     const Piece& piece = GetPiece(pos);
     if (piece.IsEmpty()) return {};
 
-    switch (piece.type) {
-        case PieceType::PAWN: return GetPawnMoves(pos);
-        case PieceType::ROOK: return GetRookMoves(pos);
-        case PieceType::KNIGHT: return GetKnightMoves(pos);
-        case PieceType::BISHOP: return GetBishopMoves(pos);
-        case PieceType::QUEEN: return GetQueenMoves(pos);
-        case PieceType::KING: return GetKingMoves(pos);
-        default: return {};
+    MoveList moves;
+    GenerateMoves(GenType::LEGAL, moves, piece.color);
+
+    int from = PositionToSquare(pos);
+    std::vector<Move> pieceMoves;
+    for (CompactMove move : moves) {
+        if (move.From() == from) {
+            pieceMoves.push_back(ToMove(move));
+        }
     }
+    return pieceMoves;
 }
 
-std::vector<Move> Board::GetPawnMoves(const Position& pos) const {
-    std::vector<Move> moves;
-    const Piece& piece = GetPiece(pos);
-    Color color = piece.color;
-
-    int direction = (color == Color::WHITE) ? -1 : 1;
-    int startRank = (color == Color::WHITE) ? 6 : 1;
-    int promotionRank = (color == Color::WHITE) ? 0 : 7;
-
-    // Forward move
-    Position forward(pos.x, pos.y + direction);
-    if (forward.IsValid() && IsEmpty(forward)) {
-        if (forward.y == promotionRank) {
-            // Promotion moves
-            moves.emplace_back(pos, forward, MoveType::PROMOTION);
-            moves.back().promotionPiece = PieceType::QUEEN;
-            moves.emplace_back(pos, forward, MoveType::PROMOTION);
-            moves.back().promotionPiece = PieceType::ROOK;
-            moves.emplace_back(pos, forward, MoveType::PROMOTION);
-            moves.back().promotionPiece = PieceType::BISHOP;
-            moves.emplace_back(pos, forward, MoveType::PROMOTION);
-            moves.back().promotionPiece = PieceType::KNIGHT;
-        } else {
-            moves.emplace_back(pos, forward);
+Move Board::ToMove(CompactMove move) const {
+    Move result = move.ToMove();
+    if (!move.IsValid()) return result;
 
-            // Double move from starting position
-            if (pos.y == startRank) {
-                Position doubleForward(pos.x, pos.y + 2 * direction);
-                if (doubleForward.IsValid() && IsEmpty(doubleForward)) {
-                    moves.emplace_back(pos, doubleForward);
-                }
+    if (move.Type() == MoveType::EN_PASSANT) {
+        result.capturedPiece = Piece(PieceType::PAWN, Opponent(mailbox[move.From()].color));
+    } else if (move.Type() != MoveType::CASTLING) {
+        result.capturedPiece = mailbox[move.To()];
+    }
+    return result;
+}
+
+void Board::GenerateMoves(GenType type, MoveList& moves, Color us) const {
+    if (type == GenType::LEGAL) {
+        // Pseudo-legal evasions already restrict non-king moves to resolving the check,
+        // so only pins and king safety are left for IsLegal to reject
+        GenerateMoves(IsInCheck(us) ? GenType::EVASIONS : GenType::NON_EVASIONS, moves, us);
+
+        // Keep only the moves that do not leave our king attacked, preserving order
+        size_t kept = 0;
+        for (size_t i = 0; i < moves.Size(); ++i) {
+            if (IsLegal(moves[i], us)) {
+                moves[kept++] = moves[i];
             }
         }
+        moves.Resize(kept);
+        return;
     }
 
-    // Capture moves
-    for (int dx : {-1, 1}) {
-        Position capture(pos.x + dx, pos.y + direction);
-        if (capture.IsValid()) {
-            const Piece& target = GetPiece(capture);
-            if (!target.IsEmpty() && target.color != color) {
-                if (capture.y == promotionRank) {
-                    // Promotion captures
-                    moves.emplace_back(pos, capture, MoveType::PROMOTION);
-                    moves.back().promotionPiece = PieceType::QUEEN;
-                    moves.emplace_back(pos, capture, MoveType::PROMOTION);
-                    moves.back().promotionPiece = PieceType::ROOK;
-                    moves.emplace_back(pos, capture, MoveType::PROMOTION);
-                    moves.back().promotionPiece = PieceType::BISHOP;
-                    moves.emplace_back(pos, capture, MoveType::PROMOTION);
-                    moves.back().promotionPiece = PieceType::KNIGHT;
-                } else {
-                    moves.emplace_back(pos, capture);
-                }
-            }
-            // En passant
-            else if (capture == enPassantTarget) {
-                moves.emplace_back(pos, capture, MoveType::EN_PASSANT);
+    Bitboard king = Pieces(us, PieceType::KING);
+    Bitboard targets;
+
+    switch (type) {
+        case GenType::CAPTURES: targets = Pieces(Opponent(us)); break;
+        case GenType::QUIETS: targets = ~occupiedBB; break;
+        case GenType::EVASIONS: {
+            int kingSq = king ? Lsb(king) : -1;
+            Bitboard checkers = (us == currentPlayer) ? checkersBB
+                              : king ? AttackersTo(kingSq, occupiedBB) & Pieces(Opponent(us)) : 0;
+            if (!checkers) {
+                GenerateMoves(GenType::NON_EVASIONS, moves, us);
+                return;
             }
+
+            GeneratePieceMoves(moves, us, PieceType::KING, ~Pieces(us));
+
+            // In double check only the king can move
+            if (MoreThanOne(checkers)) return;
+
+            // Otherwise capture the checker or block the line to it
+            targets = BetweenBB(kingSq, Lsb(checkers)) | checkers;
+            break;
         }
+        default: targets = ~Pieces(us); break;
     }
 
-    // Filter out moves that leave king in check
-    moves.erase(std::remove_if(moves.begin(), moves.end(),
-        [this, color](const Move& move) {
-            return WouldBeInCheck(move, color);
-        }), moves.end());
+    GeneratePawnMoves(moves, us, type, targets);
+    GeneratePieceMoves(moves, us, PieceType::KNIGHT, targets);
+    GeneratePieceMoves(moves, us, PieceType::BISHOP, targets);
+    GeneratePieceMoves(moves, us, PieceType::ROOK, targets);
+    GeneratePieceMoves(moves, us, PieceType::QUEEN, targets);
 
-    return moves;
+    if (type != GenType::EVASIONS) {
+        GeneratePieceMoves(moves, us, PieceType::KING, targets);
+        if (type != GenType::CAPTURES) {
+            GenerateCastling(moves, us);
+        }
+    }
 }
 
-std::vector<Move> Board::GetRookMoves(const Position& pos) const {
-    const std::vector<Position> directions = {
-        Position(-1, 0), Position(1, 0), Position(0, -1), Position(0, 1)
-    };
-    auto moves = GetSlidingMoves(pos, directions);
-
-    // Filter out moves that leave king in check
-    const Piece& piece = GetPiece(pos);
-    moves.erase(std::remove_if(moves.begin(), moves.end(),
-        [this, piece](const Move& move) {
-            return WouldBeInCheck(move, piece.color);
-        }), moves.end());
+void Board::GeneratePawnMoves(MoveList& moves, Color us, GenType type, Bitboard targets) const {
+    int forward = (us == Color::WHITE) ? -BOARD_SIZE : BOARD_SIZE;
+    int startRow = (us == Color::WHITE) ? 6 : 1;
+    int promotionRow = (us == Color::WHITE) ? 0 : 7;
+    Bitboard enemies = Pieces(Opponent(us));
+
+    Bitboard pawns = Pieces(us, PieceType::PAWN);
+    while (pawns) {
+        int from = PopLsb(pawns);
+        int to = from + forward;
+
+        // Forward moves
+        if (mailbox[to].IsEmpty()) {
+            if (SquareRow(to) == promotionRow) {
+                // Quiet promotions count as captures so they are searched with the noisy moves
+                if (type != GenType::QUIETS && (type == GenType::CAPTURES || (targets & SquareBB(to)))) {
+                    AddPromotions(moves, from, to);
+                }
+            } else if (type != GenType::CAPTURES) {
+                if (targets & SquareBB(to)) {
+                    moves.Add(CompactMove(from, to));
+                }
 
-    return moves;
-}
+                // Double move from starting position
+                int doubleTo = to + forward;
+                if (SquareRow(from) == startRow && mailbox[doubleTo].IsEmpty() && (targets & SquareBB(doubleTo))) {
+                    moves.Add(CompactMove(from, doubleTo));
+                }
+            }
+        }
 
-std::vector<Move> Board::GetKnightMoves(const Position& pos) const {
-    std::vector<Move> moves;
-    const Piece& piece = GetPiece(pos);
+        if (type == GenType::QUIETS) continue;
 
-    const std::array<Position, 8> knightMoves = {
-        Position(-2, -1), Position(-2, 1), Position(-1, -2), Position(-1, 2),
-        Position(1, -2), Position(1, 2), Position(2, -1), Position(2, 1)
-    };
+        // Capture moves
+        Bitboard captures = PawnAttacksFrom(us, from) & enemies & targets;
+        while (captures) {
+            int capSq = PopLsb(captures);
+            if (SquareRow(capSq) == promotionRow) {
+                AddPromotions(moves, from, capSq);
+            } else {
+                moves.Add(CompactMove(from, capSq));
+            }
+        }
 
-    for (const auto& offset : knightMoves) {
-        Position target(pos.x + offset.x, pos.y + offset.y);
-        if (target.IsValid()) {
-            const Piece& targetPiece = GetPiece(target);
-            if (targetPiece.IsEmpty() || targetPiece.color != piece.color) {
-                moves.emplace_back(pos, target);
+        // En passant, only available to the side to move
+        if (us == currentPlayer && enPassantTarget.IsValid()) {
+            int epSq = PositionToSquare(enPassantTarget);
+            int victimSq = epSq - forward;
+            if ((PawnAttacksFrom(us, from) & SquareBB(epSq)) && (targets & (SquareBB(epSq) | SquareBB(victimSq)))) {
+                moves.Add(CompactMove(from, epSq, MoveType::EN_PASSANT));
             }
         }
     }
-
-    // Filter out moves that leave king in check
-    moves.erase(std::remove_if(moves.begin(), moves.end(),
-        [this, piece](const Move& move) {
-            return WouldBeInCheck(move, piece.color);
-        }), moves.end());
-
-    return moves;
 }
 
-std::vector<Move> Board::GetBishopMoves(const Position& pos) const {
-    const std::vector<Position> directions = {
-        Position(-1, -1), Position(-1, 1), Position(1, -1), Position(1, 1)
-    };
-    auto moves = GetSlidingMoves(pos, directions);
+void Board::AddPromotions(MoveList& moves, int from, int to) {
+    for (PieceType promotion : { PieceType::QUEEN, PieceType::ROOK, PieceType::BISHOP, PieceType::KNIGHT }) {
+        moves.Add(CompactMove(from, to, MoveType::PROMOTION, promotion));
+    }
+}
 
-    // Filter out moves that leave king in check
-    const Piece& piece = GetPiece(pos);
-    moves.erase(std::remove_if(moves.begin(), moves.end(),
-        [this, piece](const Move& move) {
-            return WouldBeInCheck(move, piece.color);
-        }), moves.end());
+void Board::GeneratePieceMoves(MoveList& moves, Color us, PieceType type, Bitboard targets) const {
+    Bitboard pieces = Pieces(us, type);
+    while (pieces) {
+        int from = PopLsb(pieces);
+
+        Bitboard attacks;
+        switch (type) {
+            case PieceType::KNIGHT: attacks = KnightAttacksFrom(from); break;
+            case PieceType::BISHOP: attacks = BishopAttacksFrom(from, occupiedBB); break;
+            case PieceType::ROOK: attacks = RookAttacksFrom(from, occupiedBB); break;
+            case PieceType::QUEEN: attacks = QueenAttacksFrom(from, occupiedBB); break;
+            case PieceType::KING: attacks = KingAttacksFrom(from); break;
+            default: attacks = 0; break;
+        }
 
-    return moves;
+        attacks &= targets;
+        while (attacks) {
+            moves.Add(CompactMove(from, PopLsb(attacks)));
+        }
+    }
 }
 
-std::vector<Move> Board::GetQueenMoves(const Position& pos) const {
-    const std::vector<Position> directions = {
-        Position(-1, 0), Position(1, 0), Position(0, -1), Position(0, 1),
-        Position(-1, -1), Position(-1, 1), Position(1, -1), Position(1, 1)
-    };
-    auto moves = GetSlidingMoves(pos, directions);
+void Board::GenerateCastling(MoveList& moves, Color us) const {
+    Color them = Opponent(us);
+    int homeRank = (us == Color::WHITE) ? 7 : 0;
+    int kingSq = MakeSquare(4, homeRank);
 
-    // Filter out moves that leave king in check
-    const Piece& piece = GetPiece(pos);
-    moves.erase(std::remove_if(moves.begin(), moves.end(),
-        [this, piece](const Move& move) {
-            return WouldBeInCheck(move, piece.color);
-        }), moves.end());
+    if (mailbox[kingSq].type != PieceType::KING || mailbox[kingSq].color != us) return;
+    if (!CanCastleKingSide(us) && !CanCastleQueenSide(us)) return;
+    if (IsSquareAttacked(SquareToPosition(kingSq), them)) return;
 
-    return moves;
-}
+    auto IsOwnRook = [this, us](const Position& pos) {
+        return GetPiece(pos).type == PieceType::ROOK && GetPiece(pos).color == us;
+    };
 
-std::vector<Move> Board::GetKingMoves(const Position& pos) const {
-    std::vector<Move> moves;
-    const Piece& piece = GetPiece(pos);
-    Color color = piece.color;
-    Color enemyColor = (color == Color::WHITE) ? Color::BLACK : Color::WHITE;
-
-    // Regular king moves
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            if (dx == 0 && dy == 0) continue;
-
-            Position target(pos.x + dx, pos.y + dy);
-            if (target.IsValid()) {
-                const Piece& targetPiece = GetPiece(target);
-                if (targetPiece.IsEmpty() || targetPiece.color != color) {
-                    // Check if moving to this square would put king in check
-                    if (!IsSquareAttacked(target, enemyColor)) {
-                        moves.emplace_back(pos, target);
-                    }
-                }
-            }
+    // King-side castling
+    if (CanCastleKingSide(us)) {
+        Position f(5, homeRank), g(6, homeRank), h(7, homeRank);
+        if (IsEmpty(f) && IsEmpty(g) && IsOwnRook(h) &&
+            !IsSquareAttacked(f, them) && !IsSquareAttacked(g, them)) {
+            moves.Add(CompactMove(kingSq, PositionToSquare(g), MoveType::CASTLING));
         }
     }
 
-    // Castling moves
-    if (!IsInCheck(color)) {
-        int homeRank = (color == Color::WHITE) ? 7 : 0;
-
-        // King-side castling
-        if (CanCastleKingSide(color)) {
-            Position f(5, homeRank), g(6, homeRank);
-            if (IsEmpty(f) && IsEmpty(g) &&
-                !IsSquareAttacked(f, enemyColor) && !IsSquareAttacked(g, enemyColor)) {
-                moves.emplace_back(pos, g, MoveType::CASTLING);
-            }
+    // Queen-side castling
+    if (CanCastleQueenSide(us)) {
+        Position a(0, homeRank), b(1, homeRank), c(2, homeRank), d(3, homeRank);
+        if (IsEmpty(b) && IsEmpty(c) && IsEmpty(d) && IsOwnRook(a) &&
+            !IsSquareAttacked(c, them) && !IsSquareAttacked(d, them)) {
+            moves.Add(CompactMove(kingSq, PositionToSquare(c), MoveType::CASTLING));
         }
+    }
+}
 
-        // Queen-side castling
-        if (CanCastleQueenSide(color)) {
-            Position b(1, homeRank), c(2, homeRank), d(3, homeRank);
-            if (IsEmpty(b) && IsEmpty(c) && IsEmpty(d) &&
-                !IsSquareAttacked(c, enemyColor) && !IsSquareAttacked(d, enemyColor)) {
-                moves.emplace_back(pos, c, MoveType::CASTLING);
-            }
+bool Board::IsLegal(CompactMove move) const {
+    return IsLegal(move, currentPlayer);
+}
+
+bool Board::IsLegal(CompactMove move, Color us) const {
+    Bitboard king = Pieces(us, PieceType::KING);
+
+    // Castling is only generated when the king's path is safe
+    if (!king || move.Type() == MoveType::CASTLING) return true;
+
+    int from = move.From();
+    int to = move.To();
+    int kingSq = Lsb(king);
+    Color them = Opponent(us);
+
+    // En passant removes two pieces from a line at once, so play it on a copy of the
+    // occupancy and look for attackers that survive it
+    if (move.Type() == MoveType::EN_PASSANT || us != currentPlayer) {
+        Bitboard captured = SquareBB(to);
+        Bitboard occupied = (occupiedBB ^ SquareBB(from)) | SquareBB(to);
+        if (move.Type() == MoveType::EN_PASSANT) {
+            captured = SquareBB(to + ((us == Color::WHITE) ? BOARD_SIZE : -BOARD_SIZE));
+            occupied ^= captured;
         }
+        if (from == kingSq) kingSq = to;
+        return !(AttackersTo(kingSq, occupied) & Pieces(them) & ~captured);
     }
 
-    return moves;
+    // The king may not step onto an attacked square; sliders see through its old square
+    if (from == kingSq) {
+        return !(AttackersTo(to, occupiedBB ^ SquareBB(from)) & Pieces(them));
+    }
+
+    // Any other move must resolve a single check by capturing or blocking
+    if (checkersBB) {
+        if (MoreThanOne(checkersBB)) return false;
+        if (!((BetweenBB(kingSq, Lsb(checkersBB)) | checkersBB) & SquareBB(to))) return false;
+    }
+
+    // A pinned piece may only move along the line through its king
+    return !(PinnedPieces(us) & SquareBB(from)) || Aligned(from, to, kingSq);
 }
 
-std::vector<Move> Board::GetSlidingMoves(const Position& pos, const std::vector<Position>& directions) const {
-    std::vector<Move> moves;
-    const Piece& piece = GetPiece(pos);
+bool Board::IsPseudoLegal(CompactMove move) const {
+    // The generator leaves the promotion bits clear on every other move type
+    if (!move.IsValid() || (move.Type() != MoveType::PROMOTION && (move.Raw() & 0x3000))) return false;
 
-    for (const auto& dir : directions) {
-        Position current(pos.x + dir.x, pos.y + dir.y);
+    Color us = currentPlayer;
+    int from = move.From();
+    int to = move.To();
+    const Piece& piece = mailbox[from];
+    if (piece.IsEmpty() || piece.color != us) return false;
 
-        while (current.IsValid()) {
-            const Piece& targetPiece = GetPiece(current);
+    if (move.Type() == MoveType::CASTLING) {
+        MoveList castles;
+        GenerateCastling(castles, us);
+        return castles.Contains(move);
+    }
+    if (Pieces(us) & SquareBB(to)) return false;
 
-            if (targetPiece.IsEmpty()) {
-                moves.emplace_back(pos, current);
-            } else {
-                if (targetPiece.color != piece.color) {
-                    moves.emplace_back(pos, current); // Capture
-                }
-                break; // Can't move further
-            }
+    if (piece.type == PieceType::PAWN) {
+        int forward = (us == Color::WHITE) ? -BOARD_SIZE : BOARD_SIZE;
+        int startRow = (us == Color::WHITE) ? 6 : 1;
+        int promotionRow = (us == Color::WHITE) ? 0 : 7;
 
-            current.x += dir.x;
-            current.y += dir.y;
+        if (move.Type() == MoveType::EN_PASSANT) {
+            return enPassantTarget.IsValid() && to == PositionToSquare(enPassantTarget)
+                && (PawnAttacksFrom(us, from) & SquareBB(to));
         }
+        if ((SquareRow(to) == promotionRow) != (move.Type() == MoveType::PROMOTION)) return false;
+
+        if (PawnAttacksFrom(us, from) & Pieces(Opponent(us)) & SquareBB(to)) return true;
+        if (to == from + forward) return mailbox[to].IsEmpty();
+        return to == from + 2 * forward && SquareRow(from) == startRow
+            && mailbox[from + forward].IsEmpty() && mailbox[to].IsEmpty();
     }
 
-    return moves;
+    if (move.Type() != MoveType::NORMAL) return false;
+
+    Bitboard attacks;
+    switch (piece.type) {
+        case PieceType::KNIGHT: attacks = KnightAttacksFrom(from); break;
+        case PieceType::BISHOP: attacks = BishopAttacksFrom(from, occupiedBB); break;
+        case PieceType::ROOK: attacks = RookAttacksFrom(from, occupiedBB); break;
+        case PieceType::QUEEN: attacks = QueenAttacksFrom(from, occupiedBB); break;
+        case PieceType::KING: attacks = KingAttacksFrom(from); break;
+        default: attacks = 0; break;
+    }
+    return (attacks & SquareBB(to)) != 0;
 }
 
 bool Board::IsLegalMove(const Move& move) const {
-    auto legalMoves = GetPieceMoves(move.from);
-    return std::find_if(legalMoves.begin(), legalMoves.end(),
-        [&move](const Move& legal) {
-            return legal.from == move.from && legal.to == move.to &&
-                   legal.type == move.type && legal.promotionPiece == move.promotionPiece;
-        }) != legalMoves.end();
+    const Piece& piece = GetPiece(move.from);
+    if (piece.IsEmpty()) return false;
+
+    MoveList legalMoves;
+    GenerateMoves(GenType::LEGAL, legalMoves, piece.color);
+    return legalMoves.Contains(CompactMove(move));
 }
 
 bool Board::MakeMove(const Move& move) {
@@ -551,114 +700,300 @@ bool Board::MakeMove(const Move& move) {
         return false;
     }
 
-    Piece movingPiece = GetPiece(move.from);
-    Piece capturedPiece = GetPiece(move.to);
+    DoMove(CompactMove(move));
+    return true;
+}
+
+bool Board::UndoMove(const Move& move) {
+    if (stateCount == 0 || CompactMove(move) != stateStack[stateCount - 1].move) {
+        return false;
+    }
 
-    UpdateCastlingRights(move, movingPiece, capturedPiece);
-    UpdateEnPassant(move, movingPiece);
+    UndoMove(stateStack[stateCount - 1].move);
+    return true;
+}
 
-    // Handle special moves
-    switch (move.type) {
-        case MoveType::CASTLING: {
-            // Move king
-            SetPiece(move.to, movingPiece);
-            SetPiece(move.from, Piece());
-
-            // Move rook
-            int homeRank = (movingPiece.color == Color::WHITE) ? 7 : 0;
-            if (move.to.x == 6) { // King-side castling
-                SetPiece(Position(5, homeRank), GetPiece(Position(7, homeRank)));
-                SetPiece(Position(7, homeRank), Piece());
-            } else { // Queen-side castling
-                SetPiece(Position(3, homeRank), GetPiece(Position(0, homeRank)));
-                SetPiece(Position(0, homeRank), Piece());
+namespace {
+
+// Castling rights lost when a piece moves from or to the given square
+uint8_t CastlingRightsLost(int sq) {
+    switch (sq) {
+        case MakeSquare(0, 7): return WHITE_QUEEN_SIDE;
+        case MakeSquare(7, 7): return WHITE_KING_SIDE;
+        case MakeSquare(4, 7): return WHITE_KING_SIDE | WHITE_QUEEN_SIDE;
+        case MakeSquare(0, 0): return BLACK_QUEEN_SIDE;
+        case MakeSquare(7, 0): return BLACK_KING_SIDE;
+        case MakeSquare(4, 0): return BLACK_KING_SIDE | BLACK_QUEEN_SIDE;
+        default: return 0;
+    }
+}
+
+// Rook squares for a castling move, given the king's destination
+void CastlingRookSquares(int kingTo, int& rookFrom, int& rookTo) {
+    int homeRank = SquareRow(kingTo);
+    bool kingSide = SquareFile(kingTo) == 6;
+    rookFrom = MakeSquare(kingSide ? 7 : 0, homeRank);
+    rookTo = MakeSquare(kingSide ? 5 : 3, homeRank);
+}
+
+} // namespace
+
+bool Board::GivesCheck(CompactMove move) const {
+    Color us = currentPlayer;
+    Color them = Opponent(us);
+    Bitboard king = Pieces(them, PieceType::KING);
+    if (!king) return false;
+
+    int kingSq = Lsb(king);
+    int from = move.From();
+    int to = move.To();
+
+    // Direct check by the moved piece; a promoting pawn never stands on a pawn check square
+    if (checkSquares[static_cast<int>(mailbox[from].type)] & SquareBB(to)) return true;
+
+    // Discovered check, unless the piece stays on the line to the king
+    if ((blockersForKing[ColorIndex(them)] & SquareBB(from)) && !Aligned(from, to, kingSq)) return true;
+
+    switch (move.Type()) {
+        case MoveType::PROMOTION: {
+            Bitboard occupied = occupiedBB ^ SquareBB(from);
+            switch (move.Promotion()) {
+                case PieceType::KNIGHT: return (KnightAttacksFrom(to) & king) != 0;
+                case PieceType::BISHOP: return (BishopAttacksFrom(to, occupied) & king) != 0;
+                case PieceType::ROOK: return (RookAttacksFrom(to, occupied) & king) != 0;
+                default: return (QueenAttacksFrom(to, occupied) & king) != 0;
             }
-            break;
         }
         case MoveType::EN_PASSANT: {
-            SetPiece(move.to, movingPiece);
-            SetPiece(move.from, Piece());
-            // Remove captured pawn
-            int capturedRank = (movingPiece.color == Color::WHITE) ? 4 : 3;
-            SetPiece(Position(move.to.x, capturedRank), Piece());
-            break;
-        }
-        case MoveType::PROMOTION: {
-            SetPiece(move.to, Piece(move.promotionPiece, movingPiece.color));
-            SetPiece(move.from, Piece());
-            break;
+            // The captured pawn may have been the only piece between a slider and the king
+            int victimSq = to + ((us == Color::WHITE) ? BOARD_SIZE : -BOARD_SIZE);
+            Bitboard occupied = (occupiedBB ^ SquareBB(from) ^ SquareBB(victimSq)) | SquareBB(to);
+            return (RookAttacksFrom(kingSq, occupied) & (Pieces(us, PieceType::ROOK) | Pieces(us, PieceType::QUEEN)))
+                || (BishopAttacksFrom(kingSq, occupied) & (Pieces(us, PieceType::BISHOP) | Pieces(us, PieceType::QUEEN)));
         }
-        default: {
-            SetPiece(move.to, movingPiece);
-            SetPiece(move.from, Piece());
-            break;
+        case MoveType::CASTLING: {
+            int rookFrom, rookTo;
+            CastlingRookSquares(to, rookFrom, rookTo);
+            Bitboard occupied = (occupiedBB ^ SquareBB(from) ^ SquareBB(rookFrom)) | SquareBB(to) | SquareBB(rookTo);
+            return (RookAttacksFrom(rookTo, occupied) & king) != 0;
         }
+        default:
+            return false;
     }
+}
 
-    if (movingPiece.type == PieceType::PAWN || !capturedPiece.IsEmpty()) {
-        ResetHalfMoveClock();
+void Board::MovePiece(int from, int to) {
+    Piece piece = mailbox[from];
+    RemovePiece(from);
+    PutPiece(to, piece);
+}
+
+void Board::PushState(const StateInfo& state) {
+    if (stateCount == static_cast<int>(stateStack.size())) {
+        stateStack.push_back(state);
+    } else {
+        stateStack[stateCount] = state;
     }
-    else {
+    ++stateCount;
+}
+
+void Board::DoMove(CompactMove move) {
+    Color us = currentPlayer;
+    int from = move.From();
+    int to = move.To();
+    MoveType type = move.Type();
+    Piece movingPiece = mailbox[from];
+#ifndef NDEBUG
+    bool givesCheck = GivesCheck(move);
+#endif
+
+    StateInfo state;
+    state.move = move;
+    state.castlingRights = castlingRights;
+    state.enPassantTarget = enPassantTarget;
+    state.halfMoveClock = halfMoveClock;
+    state.pliesFromNull = pliesFromNull;
+    state.checkers = checkersBB;
+    state.blockersForKing = blockersForKing;
+    state.checkSquares = checkSquares;
+    state.key = key;
+    state.pawnKey = pawnKey;
+    state.materialKey = materialKey;
+    if (nnueEnabled) {
+        accumulatorStack.Push(accumulator);
+    }
+
+    // Side, castling and en passant leave the key here and are added back once the move is made
+    key ^= ZobristHash::SideToMoveKey() ^ ZobristHash::CastleKey(castlingRights);
+    if (ZobristHash::EnPassantMatters(*this)) {
+        key ^= ZobristHash::EnPassantKey(enPassantTarget.x);
+    }
+
+    // Remove the captured piece, which for en passant is not on the target square
+    if (type == MoveType::EN_PASSANT) {
+        int victimSq = to + ((us == Color::WHITE) ? BOARD_SIZE : -BOARD_SIZE);
+        state.captured = mailbox[victimSq];
+        RemovePiece(victimSq);
+    } else {
+        state.captured = mailbox[to];
+        RemovePiece(to);
+    }
+    PushState(state);
+
+    MovePiece(from, to);
+    if (type == MoveType::CASTLING) {
+        int rookFrom, rookTo;
+        CastlingRookSquares(to, rookFrom, rookTo);
+        MovePiece(rookFrom, rookTo);
+    } else if (type == MoveType::PROMOTION) {
+        RemovePiece(to);
+        PutPiece(to, Piece(move.Promotion(), us));
+    }
+
+    castlingRights &= ~(CastlingRightsLost(from) | CastlingRightsLost(to));
+    key ^= ZobristHash::CastleKey(castlingRights);
+
+    // If pawn double-moved, set en-passant target square
+    enPassantTarget = Position();
+    if (movingPiece.type == PieceType::PAWN && std::abs(to - from) == 2 * BOARD_SIZE) {
+        enPassantTarget = SquareToPosition((from + to) / 2);
+    }
+
+    if (movingPiece.type == PieceType::PAWN || !state.captured.IsEmpty()) {
+        ResetHalfMoveClock();
+    } else {
         IncrementHalfMoveClock();
     }
 
-    if (currentPlayer == Color::BLACK) {
+    if (us == Color::BLACK) {
         IncrementFullMoveNumber();
     }
+    ++pliesFromNull;
 
     // Switch player and record position
-    SwitchPlayer();
-    AddToHistory();
-
-    return true;
+    currentPlayer = Opponent(us);
+    if (ZobristHash::EnPassantMatters(*this)) {
+        key ^= ZobristHash::EnPassantKey(enPassantTarget.x);
+    }
+    SetCheckInfo();
+
+#ifndef NDEBUG
+    assert(key == ZobristHash::getHash(*this));
+    assert(pawnKey == ZobristHash::getPawnHash(*this));
+    assert(materialKey == ZobristHash::getMaterialHash(*this));
+    assert(psqt == ComputePsqt());
+    assert(givesCheck == InCheck());
+#endif
 }
 
-bool Board::UndoMove(const Move& move) {
-    // This is a simplified undo - in a full implementation, you'd store more state
-    // For now, we'll implement the basic structure
+void Board::UndoMove(CompactMove move) {
+    currentPlayer = Opponent(currentPlayer);
 
-    // Switch player back
-    SwitchPlayer();
+    Color us = currentPlayer;
+    const StateInfo& state = stateStack[--stateCount];
+    int from = move.From();
+    int to = move.To();
 
-    // Restore pieces (this would need to store captured piece info)
-    Piece movingPiece = GetPiece(move.to);
-    SetPiece(move.from, movingPiece);
-    SetPiece(move.to, move.capturedPiece);
+    // A saved accumulator is put back whole, so the pieces can move without updating it.
+    // A board copied after the move was made has none and updates piece by piece.
+    bool restoreAccumulator = nnueEnabled && !accumulatorStack.Empty();
+    if (restoreAccumulator) {
+        nnueEnabled = false;
+    }
 
-    // Handle special moves (simplified)
-    switch (move.type) {
-        case MoveType::CASTLING: {
-            int homeRank = (movingPiece.color == Color::WHITE) ? 7 : 0;
-            if (move.to.x == 6) { // King-side castling
-                SetPiece(Position(7, homeRank), GetPiece(Position(5, homeRank)));
-                SetPiece(Position(5, homeRank), Piece());
-            } else { // Queen-side castling
-                SetPiece(Position(0, homeRank), GetPiece(Position(3, homeRank)));
-                SetPiece(Position(3, homeRank), Piece());
-            }
-            break;
-        }
-        case MoveType::EN_PASSANT: {
-            int capturedRank = (movingPiece.color == Color::WHITE) ? 4 : 3;
-            SetPiece(Position(move.to.x, capturedRank), Piece(PieceType::PAWN,
-                     movingPiece.color == Color::WHITE ? Color::BLACK : Color::WHITE));
-            break;
-        }
-        case MoveType::PROMOTION: {
-            SetPiece(move.from, Piece(PieceType::PAWN, movingPiece.color));
-            break;
-        }
-        default:
-            break;
+    if (move.Type() == MoveType::PROMOTION) {
+        RemovePiece(to);
+        PutPiece(from, Piece(PieceType::PAWN, us));
+    } else {
+        MovePiece(to, from);
     }
 
-    return true;
+    if (move.Type() == MoveType::CASTLING) {
+        int rookFrom, rookTo;
+        CastlingRookSquares(to, rookFrom, rookTo);
+        MovePiece(rookTo, rookFrom);
+    }
+
+    if (!state.captured.IsEmpty()) {
+        int victimSq = (move.Type() == MoveType::EN_PASSANT)
+            ? to + ((us == Color::WHITE) ? BOARD_SIZE : -BOARD_SIZE)
+            : to;
+        PutPiece(victimSq, state.captured);
+    }
+
+    if (restoreAccumulator) {
+        nnueEnabled = true;
+        accumulatorStack.Pop(accumulator);
+    }
+
+    castlingRights = state.castlingRights;
+    enPassantTarget = state.enPassantTarget;
+    halfMoveClock = state.halfMoveClock;
+    pliesFromNull = state.pliesFromNull;
+    checkersBB = state.checkers;
+    blockersForKing = state.blockersForKing;
+    checkSquares = state.checkSquares;
+    key = state.key;
+    pawnKey = state.pawnKey;
+    materialKey = state.materialKey;
+    if (us == Color::BLACK) {
+        fullMoveNumber--;
+    }
+}
+
+void Board::DoNullMove() {
+    StateInfo state;
+    state.move = CompactMove();
+    state.captured = Piece();
+    state.castlingRights = castlingRights;
+    state.enPassantTarget = enPassantTarget;
+    state.halfMoveClock = halfMoveClock;
+    state.pliesFromNull = pliesFromNull;
+    state.checkers = checkersBB;
+    state.blockersForKing = blockersForKing;
+    state.checkSquares = checkSquares;
+    state.key = key;
+    state.pawnKey = pawnKey;
+    state.materialKey = materialKey;
+    PushState(state);
+
+    // The en passant right lapses when the turn is passed
+    if (ZobristHash::EnPassantMatters(*this)) {
+        key ^= ZobristHash::EnPassantKey(enPassantTarget.x);
+    }
+    enPassantTarget = Position();
+    key ^= ZobristHash::SideToMoveKey();
+
+    ++halfMoveClock;
+    pliesFromNull = 0;
+    currentPlayer = Opponent(currentPlayer);
+
+    // We were not in check, so the opponent cannot be in check now either; pins depend
+    // only on piece placement and are unchanged, check squares are now the opponent's
+    checkersBB = 0;
+    SetCheckSquares();
+
+#ifndef NDEBUG
+    assert(key == ZobristHash::getHash(*this));
+#endif
+}
+
+void Board::UndoNullMove() {
+    const StateInfo& state = stateStack[--stateCount];
+    currentPlayer = Opponent(currentPlayer);
+    enPassantTarget = state.enPassantTarget;
+    halfMoveClock = state.halfMoveClock;
+    pliesFromNull = state.pliesFromNull;
+    checkersBB = state.checkers;
+    checkSquares = state.checkSquares;
+    key = state.key;
 }
 
 GameResult Board::GetGameResult() const {
-    auto legalMoves = GetAllLegalMoves(currentPlayer);
+    MoveList legalMoves;
+    GenerateMoves(GenType::LEGAL, legalMoves);
 
-    if (legalMoves.empty()) {
+    if (legalMoves.Empty()) {
         if (IsInCheck(currentPlayer)) {
             return (currentPlayer == Color::WHITE) ? GameResult::CHECKMATE_BLACK : GameResult::CHECKMATE_WHITE;
         } else {
@@ -683,107 +1018,145 @@ GameResult Board::GetGameResult() const {
 }
 
 bool Board::IsStalemate(Color color) const {
-    return !IsInCheck(color) && GetAllLegalMoves(color).empty();
+    MoveList legalMoves;
+    GenerateMoves(GenType::LEGAL, legalMoves, color);
+    return legalMoves.Empty() && !IsInCheck(color);
 }
 
 bool Board::IsCheckmate(Color color) const {
-    return IsInCheck(color) && GetAllLegalMoves(color).empty();
+    MoveList legalMoves;
+    GenerateMoves(GenType::LEGAL, legalMoves, color);
+    return legalMoves.Empty() && IsInCheck(color);
 }
 
 bool Board::IsInsufficientMaterial() const {
-    std::vector<Piece> pieces;
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            const Piece& piece = GetPiece(x, y);
-            if (!piece.IsEmpty()) {
-                pieces.push_back(piece);
-            }
-        }
-    }
+    int pieceCount = PopCount(occupiedBB);
 
     // King vs King
-    if (pieces.size() == 2) return true;
+    if (pieceCount == 2) return true;
 
     // King vs King + Knight/Bishop
-    if (pieces.size() == 3) {
-        for (const auto& piece : pieces) {
-            if (piece.type == PieceType::KNIGHT || piece.type == PieceType::BISHOP) {
-                return true;
-            }
-        }
+    if (pieceCount == 3) {
+        return (Pieces(PieceType::KNIGHT) | Pieces(PieceType::BISHOP)) != 0;
     }
 
     return false;
 }
 
-bool Board::IsThreefoldRepetition() const {
-    if (positionHistory.size() < 3) return false;
-
-    std::string currentPos = GetPositionHash();
+int Board::RepetitionCount(int limit) const {
+    // Each state entry holds the key of the position before its move, so the position
+    // i plies back is stateStack[stateCount - i]. Only positions with the same side to
+    // move can match, and nothing before the last capture, pawn move or null move can.
+    int end = std::min({ halfMoveClock, pliesFromNull, stateCount });
     int count = 0;
-    for (const auto& pos : positionHistory) {
-        if (pos == currentPos && ++count >= 3) return true;
+    for (int i = 4; i <= end; i += 2) {
+        if (stateStack[stateCount - i].key == key && ++count >= limit) break;
     }
-    return false;
+    return count;
 }
 
-float Board::EvaluatePosition(Color perspective) const {
-    float evaluation = 0.0f;
+bool Board::IsRepetition() const {
+    return RepetitionCount(1) >= 1;
+}
 
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            const Piece& piece = GetPiece(x, y);
-            if (!piece.IsEmpty()) {
-                float pieceValue = GetPieceValue(piece.type);
-                float positionValue = GetPositionValue(Position(x, y), piece.type, piece.color);
-
-                float totalValue = pieceValue + positionValue;
-                if (piece.color == Color::WHITE) {
-                    evaluation += totalValue;
-                } else {
-                    evaluation -= totalValue;
-                }
-            }
-        }
+bool Board::IsThreefoldRepetition() const {
+    return RepetitionCount(2) >= 2;
+}
+
+Value Board::EvaluatePosition(Color perspective, PawnTable* pawns) const {
+    PawnEntry scratch;
+    PawnEntry* pawnEntry = &scratch;
+    if (pawns) {
+        pawnEntry = pawns->Probe(*this);
+    } else {
+        EvaluatePawns(*this, scratch);
     }
+    Score score = psqt + pawnEntry->score
+                + pawnEntry->KingShelter(*this, Color::WHITE) - pawnEntry->KingShelter(*this, Color::BLACK);
+
+    // Blend the midgame and endgame scores by the material left; promotions can push
+    // the phase past its starting value
+    int phase = std::min(gamePhase, PSQT::MAX_PHASE);
+    Value evaluation = (score.mg * phase + score.eg * (PSQT::MAX_PHASE - phase)) / PSQT::MAX_PHASE;
 
     // Return from perspective of the given color
     return (perspective == Color::WHITE) ? evaluation : -evaluation;
 }
 
-float Board::GetPieceValue(PieceType type) const {
-    switch (type) {
-        case PieceType::PAWN: return 100.0f;
-        case PieceType::KNIGHT: return 320.0f;
-        case PieceType::BISHOP: return 330.0f;
-        case PieceType::ROOK: return 500.0f;
-        case PieceType::QUEEN: return 900.0f;
-        case PieceType::KING: return 20000.0f;
-        default: return 0.0f;
+Value Board::Evaluate(Color perspective, PawnTable* pawns) {
+    if (!nnueEnabled) {
+        return EvaluatePosition(perspective, pawns);
+    }
+    for (Color side : { Color::WHITE, Color::BLACK }) {
+        if (!accumulator.computed[ColorIndex(side)]) {
+            NNUE::Refresh(*this, side, accumulator);
+        }
     }
+
+#ifndef NDEBUG
+    NNUE::Accumulator fresh;
+    NNUE::Refresh(*this, Color::WHITE, fresh);
+    NNUE::Refresh(*this, Color::BLACK, fresh);
+    assert(std::equal(&fresh.values[0][0], &fresh.values[0][0] + COLOR_NB * NNUE::L1_SIZE, &accumulator.values[0][0]));
+#endif
+
+    // The network scores the side to move
+    Value evaluation = NNUE::Evaluate(accumulator, currentPlayer);
+    return (perspective == currentPlayer) ? evaluation : -evaluation;
+}
+
+void Board::UseNnue(bool enable) {
+    assert(!enable || NNUE::IsLoaded());
+    nnueEnabled = enable;
+    accumulator.computed[0] = accumulator.computed[1] = false;
+    accumulatorStack.Clear();
 }
 
-float Board::GetPositionValue(const Position& pos, PieceType type, Color color) const {
-    if (!pos.IsValid()) return 0.0f;
+void Board::UpdateAccumulator(const Piece& piece, int sq, bool added) {
+    for (Color perspective : { Color::WHITE, Color::BLACK }) {
+        int p = ColorIndex(perspective);
+        if (!accumulator.computed[p]) continue;
 
-    int x = pos.x, y = pos.y;
+        // Every feature depends on the own king's square, so a king move means a refresh
+        if (piece.type == PieceType::KING) {
+            if (piece.color == perspective) {
+                accumulator.computed[p] = false;
+            }
+            continue;
+        }
 
-    // Flip board for black pieces
-    if (color == Color::BLACK) {
-        y = BOARD_SIZE - 1 - y;
+        int index = NNUE::FeatureIndex(perspective, Lsb(pieceBB[p][static_cast<int>(PieceType::KING)]),
+                                       piece.color, piece.type, sq);
+        if (added) {
+            NNUE::AddFeature(accumulator, perspective, index);
+        } else {
+            NNUE::RemoveFeature(accumulator, perspective, index);
+        }
     }
+}
 
+Value Board::GetPieceValue(PieceType type) const {
     switch (type) {
-        case PieceType::PAWN: return PAWN_TABLE[y][x];
-        case PieceType::KNIGHT: return KNIGHT_TABLE[y][x];
-        case PieceType::BISHOP: return BISHOP_TABLE[y][x];
-        case PieceType::ROOK: return ROOK_TABLE[y][x];
-        case PieceType::QUEEN: return QUEEN_TABLE[y][x];
-        case PieceType::KING: return KING_TABLE[y][x];
-        default: return 0.0f;
+        case PieceType::PAWN: return 100;
+        case PieceType::KNIGHT: return 320;
+        case PieceType::BISHOP: return 330;
+        case PieceType::ROOK: return 500;
+        case PieceType::QUEEN: return 900;
+        case PieceType::KING: return 20000;
+        default: return 0;
     }
 }
 
+Score Board::ComputePsqt() const {
+    Score score;
+    Bitboard occupied = occupiedBB;
+    while (occupied) {
+        int sq = PopLsb(occupied);
+        score += PSQT::PieceScore(mailbox[sq].color, mailbox[sq].type, sq);
+    }
+    return score;
+}
+
 std::string Board::ToFEN() const {
     std::ostringstream fen;
 
@@ -816,10 +1189,10 @@ std::string Board::ToFEN() const {
     // Castling rights
     fen << ' ';
     std::string castling;
-    if (whiteKingSideCastle) castling += 'K';
-    if (whiteQueenSideCastle) castling += 'Q';
-    if (blackKingSideCastle) castling += 'k';
-    if (blackQueenSideCastle) castling += 'q';
+    if (castlingRights & WHITE_KING_SIDE) castling += 'K';
+    if (castlingRights & WHITE_QUEEN_SIDE) castling += 'Q';
+    if (castlingRights & BLACK_KING_SIDE) castling += 'k';
+    if (castlingRights & BLACK_QUEEN_SIDE) castling += 'q';
     fen << (castling.empty() ? "-" : castling);
 
     // En passant target
@@ -834,10 +1207,10 @@ std::string Board::ToFEN() const {
 bool Board::LoadFromFEN(const std::string& fen) {
     // Simplified FEN loading - full implementation would be more robust
     std::istringstream ss(fen);
-    std::string piecePlacement, activeColor, castlingRights, enPassant;
+    std::string piecePlacement, activeColor, castling, enPassant;
     int halfmove, fullmove;
 
-    if (!(ss >> piecePlacement >> activeColor >> castlingRights >> enPassant >> halfmove >> fullmove)) {
+    if (!(ss >> piecePlacement >> activeColor >> castling >> enPassant >> halfmove >> fullmove)) {
         return false;
     }
 
@@ -872,16 +1245,15 @@ bool Board::LoadFromFEN(const std::string& fen) {
     // Set other properties
     currentPlayer = (activeColor == "w") ? Color::WHITE : Color::BLACK;
 
-    whiteKingSideCastle = castlingRights.find('K') != std::string::npos;
-    whiteQueenSideCastle = castlingRights.find('Q') != std::string::npos;
-    blackKingSideCastle = castlingRights.find('k') != std::string::npos;
-    blackQueenSideCastle = castlingRights.find('q') != std::string::npos;
+    SetCastlingRights(Color::WHITE, castling.find('K') != std::string::npos, castling.find('Q') != std::string::npos);
+    SetCastlingRights(Color::BLACK, castling.find('k') != std::string::npos, castling.find('q') != std::string::npos);
 
     enPassantTarget = (enPassant != "-") ? Position(enPassant) : Position();
     halfMoveClock = halfmove;
     fullMoveNumber = fullmove;
 
-    AddToHistory();
+    SetCheckInfo();
+    SetKeys();
     return true;
 }
 
@@ -903,24 +1275,6 @@ std::string Board::ToString() const {
     return ss.str();
 }
 
-std::string Board::GetPositionHash() const {
-    std::istringstream ss(ToFEN());
-    std::string placement, active, castling, enpass;
-    if (!(ss >> placement >> active >> castling >> enpass)) {
-        return ToFEN(); // fallback
-    }
-    // include placement, active color, castling rights and en-passant target
-    return placement + " " + active + " " + castling + " " + enpass;
-}
-
-void Board::AddToHistory() {
-    positionHistory.push_back(GetPositionHash());
-}
-
-void Board::ClearHistory() {
-    positionHistory.clear();
-}
-
 bool Board::IsValidPosition(const Position& pos) const {
     return IsValidPosition(pos.x, pos.y);
 }
@@ -933,63 +1287,4 @@ bool Board::IsValidSquare(int x, int y) {
     return x >= 0 && x < BOARD_SIZE && y >= 0 && y < BOARD_SIZE;
 }
 
-bool Board::WouldBeInCheck(const Move& move, Color color) const {
-    // Create a temporary board to test the move
-    Board tempBoard = *this;
-
-    // Make the move on temporary board
-    Piece movingPiece = tempBoard.GetPiece(move.from);
-    tempBoard.SetPiece(move.to, movingPiece);
-    tempBoard.SetPiece(move.from, Piece());
-
-    // Handle special moves
-    if (move.type == MoveType::EN_PASSANT) {
-        int capturedRank = (color == Color::WHITE) ? 4 : 3;
-        tempBoard.SetPiece(Position(move.to.x, capturedRank), Piece());
-    }
-
-    return tempBoard.IsInCheck(color);
-}
-
-void Board::UpdateCastlingRights(const Move& move, const Piece& movingPiece, const Piece& capturedPiece) {
-    // King moves disable castling for that color
-    if (movingPiece.type == PieceType::KING) {
-        SetCastlingRights(movingPiece.color, false, false);
-    }
-
-    // Rook moves disable castling on that side
-    if (movingPiece.type == PieceType::ROOK) {
-        if (movingPiece.color == Color::WHITE) {
-            if (move.from.x == 0 && move.from.y == 7) whiteQueenSideCastle = false;
-            if (move.from.x == 7 && move.from.y == 7) whiteKingSideCastle = false;
-        }
-        else {
-            if (move.from.x == 0 && move.from.y == 0) blackQueenSideCastle = false;
-            if (move.from.x == 7 && move.from.y == 0) blackKingSideCastle = false;
-        }
-    }
-
-    // Rook captures disable castling on the captured side
-    if (capturedPiece.type == PieceType::ROOK) {
-        if (capturedPiece.color == Color::WHITE) {
-            if (move.to.x == 0 && move.to.y == 7) whiteQueenSideCastle = false;
-            if (move.to.x == 7 && move.to.y == 7) whiteKingSideCastle = false;
-        }
-        else {
-            if (move.to.x == 0 && move.to.y == 0) blackQueenSideCastle = false;
-            if (move.to.x == 7 && move.to.y == 0) blackKingSideCastle = false;
-        }
-    }
-}
-
-void Board::UpdateEnPassant(const Move& move, const Piece& movingPiece) {
-    // Clear previous en passant target
-    enPassantTarget = Position();
-
-    // If pawn double-moved, set en-passant target square
-    if (movingPiece.type == PieceType::PAWN && std::abs(move.to.y - move.from.y) == 2) {
-        enPassantTarget = Position(move.from.x, (move.from.y + move.to.y) / 2);
-    }
-}
-
 } // namespace Chess
\ No newline at end of file
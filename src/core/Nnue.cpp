@@ -0,0 +1,334 @@
+#include "core/Nnue.h"
+#include "core/Board.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define NNUE_HAS_X86_SIMD 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define NNUE_TARGET(isa)
+#else
+// Compiled for the instruction set regardless of the global flags, only called once
+// the CPU is known to support it
+#define NNUE_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define NNUE_HAS_X86_SIMD 0
+#endif
+
+namespace Chess {
+namespace NNUE {
+
+namespace {
+
+struct Network {
+    alignas(64) int16_t featureBiases[L1_SIZE];
+    alignas(64) int16_t featureWeights[INPUT_SIZE][L1_SIZE];
+    alignas(64) int32_t l2Biases[L2_SIZE];
+    alignas(64) int8_t l2Weights[L2_SIZE][2 * L1_SIZE];
+    alignas(64) int32_t l3Biases[L3_SIZE];
+    alignas(64) int8_t l3Weights[L3_SIZE][L2_SIZE];
+    int32_t outputBias;
+    alignas(64) int8_t outputWeights[L3_SIZE];
+};
+
+std::unique_ptr<Network> network;
+
+// ---- Scalar kernels, the reference the SIMD versions must match exactly ----
+
+void AddColumnScalar(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; ++i) {
+        values[i] = static_cast<int16_t>(values[i] + column[i]);
+    }
+}
+
+void SubColumnScalar(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; ++i) {
+        values[i] = static_cast<int16_t>(values[i] - column[i]);
+    }
+}
+
+void ClipScalar(const int16_t* input, uint8_t* output, int size) {
+    for (int i = 0; i < size; ++i) {
+        output[i] = static_cast<uint8_t>(std::clamp<int>(input[i], 0, 127));
+    }
+}
+
+void AffineScalar(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                  int32_t* output, int outputSize) {
+    for (int o = 0; o < outputSize; ++o) {
+        const int8_t* row = weights + o * inputSize;
+        int32_t sum = biases[o];
+        for (int i = 0; i < inputSize; ++i) {
+            sum += input[i] * row[i];
+        }
+        output[o] = sum;
+    }
+}
+
+#if NNUE_HAS_X86_SIMD
+
+// ---- AVX2: 16 accumulator lanes, 32 affine inputs per step ----
+
+NNUE_TARGET("avx2") void AddColumnAvx2(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), _mm256_add_epi16(v, c));
+    }
+}
+
+NNUE_TARGET("avx2") void SubColumnAvx2(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; i += 16) {
+        __m256i v = _mm256_load_si256(reinterpret_cast<const __m256i*>(values + i));
+        __m256i c = _mm256_load_si256(reinterpret_cast<const __m256i*>(column + i));
+        _mm256_store_si256(reinterpret_cast<__m256i*>(values + i), _mm256_sub_epi16(v, c));
+    }
+}
+
+NNUE_TARGET("avx2") void ClipAvx2(const int16_t* input, uint8_t* output, int size) {
+    const __m256i zero = _mm256_setzero_si256();
+    for (int i = 0; i < size; i += 32) {
+        __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i));
+        __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(input + i + 16));
+        // Saturating to int8 caps at 127; packing works per 128-bit lane, so the
+        // permute puts the quarters back in order
+        __m256i packed = _mm256_max_epi8(_mm256_packs_epi16(a, b), zero);
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(output + i), packed);
+    }
+}
+
+NNUE_TARGET("avx2") void AffineAvx2(const uint8_t* input, int inputSize, const int8_t* weights,
+                                    const int32_t* biases, int32_t* output, int outputSize) {
+    const __m256i ones = _mm256_set1_epi16(1);
+    for (int o = 0; o < outputSize; ++o) {
+        const int8_t* row = weights + o * inputSize;
+        __m256i sum = _mm256_setzero_si256();
+        for (int i = 0; i < inputSize; i += 32) {
+            __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(input + i));
+            __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i));
+            // Inputs are at most 127, so the pairwise int16 sums cannot saturate
+            sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(x, w), ones));
+        }
+        __m128i s = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0x4E));
+        s = _mm_add_epi32(s, _mm_shuffle_epi32(s, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(s);
+    }
+}
+
+// ---- SSE4.1: the same in 128-bit registers ----
+
+NNUE_TARGET("sse4.1") void AddColumnSse41(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; i += 8) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(values + i), _mm_add_epi16(v, c));
+    }
+}
+
+NNUE_TARGET("sse4.1") void SubColumnSse41(int16_t* values, const int16_t* column) {
+    for (int i = 0; i < L1_SIZE; i += 8) {
+        __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(values + i));
+        __m128i c = _mm_load_si128(reinterpret_cast<const __m128i*>(column + i));
+        _mm_store_si128(reinterpret_cast<__m128i*>(values + i), _mm_sub_epi16(v, c));
+    }
+}
+
+NNUE_TARGET("sse4.1") void ClipSse41(const int16_t* input, uint8_t* output, int size) {
+    const __m128i zero = _mm_setzero_si128();
+    for (int i = 0; i < size; i += 16) {
+        __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(input + i));
+        __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(input + i + 8));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + i), _mm_max_epi8(_mm_packs_epi16(a, b), zero));
+    }
+}
+
+NNUE_TARGET("sse4.1") void AffineSse41(const uint8_t* input, int inputSize, const int8_t* weights,
+                                      const int32_t* biases, int32_t* output, int outputSize) {
+    const __m128i ones = _mm_set1_epi16(1);
+    for (int o = 0; o < outputSize; ++o) {
+        const int8_t* row = weights + o * inputSize;
+        __m128i sum = _mm_setzero_si128();
+        for (int i = 0; i < inputSize; i += 16) {
+            __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input + i));
+            __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + i));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(_mm_maddubs_epi16(x, w), ones));
+        }
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+        sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+        output[o] = biases[o] + _mm_cvtsi128_si32(sum);
+    }
+}
+
+bool CpuHasAvx2() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    bool osSavesYmm = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return osSavesYmm && (info[1] & (1 << 5));
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool CpuHasSse41() {
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 19)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse4.1");
+#endif
+}
+
+#endif // NNUE_HAS_X86_SIMD
+
+struct Kernels {
+    const char* name;
+    void (*addColumn)(int16_t* values, const int16_t* column);
+    void (*subColumn)(int16_t* values, const int16_t* column);
+    void (*clip)(const int16_t* input, uint8_t* output, int size);
+    void (*affine)(const uint8_t* input, int inputSize, const int8_t* weights, const int32_t* biases,
+                   int32_t* output, int outputSize);
+};
+
+// The widest instruction set the CPU supports, decided once at startup. Every layer
+// size is a multiple of the widest step above.
+Kernels SelectKernels() {
+#if NNUE_HAS_X86_SIMD
+    if (CpuHasAvx2()) return { "avx2", AddColumnAvx2, SubColumnAvx2, ClipAvx2, AffineAvx2 };
+    if (CpuHasSse41()) return { "sse4.1", AddColumnSse41, SubColumnSse41, ClipSse41, AffineSse41 };
+#endif
+    return { "scalar", AddColumnScalar, SubColumnScalar, ClipScalar, AffineScalar };
+}
+
+const Kernels KERNELS = SelectKernels();
+
+static_assert(L1_SIZE % 32 == 0 && L2_SIZE % 32 == 0 && L3_SIZE % 32 == 0,
+              "layer sizes must be multiples of the widest kernel step");
+
+// Hidden layer activation: scale the int32 sums back down and clip to [0, 127]
+void ClipHidden(const int32_t* input, uint8_t* output, int size) {
+    for (int i = 0; i < size; ++i) {
+        output[i] = static_cast<uint8_t>(std::clamp(input[i] >> WEIGHT_SHIFT, 0, 127));
+    }
+}
+
+// The file is little-endian, as is every platform the engine is built for, so arrays
+// are read straight into place
+template <typename T>
+bool ReadArray(std::istream& in, T* data, size_t count) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(sizeof(T) * count)));
+}
+
+} // namespace
+
+bool LoadNetwork(const std::string& path, std::string* error) {
+    auto fail = [error](const std::string& reason) {
+        if (error) *error = reason;
+        return false;
+    };
+
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return fail("cannot open " + path);
+    }
+
+    uint32_t header[5];
+    if (!ReadArray(in, header, 5) || header[0] != FILE_MAGIC) {
+        return fail(path + " is not a network file");
+    }
+    if (header[1] != FILE_VERSION) {
+        return fail(path + " has format version " + std::to_string(header[1])
+                    + ", expected " + std::to_string(FILE_VERSION));
+    }
+    if (header[2] != L1_SIZE || header[3] != L2_SIZE || header[4] != L3_SIZE) {
+        return fail(path + " has a different network architecture");
+    }
+
+    auto loaded = std::make_unique<Network>();
+    bool ok = ReadArray(in, loaded->featureBiases, L1_SIZE)
+           && ReadArray(in, &loaded->featureWeights[0][0], static_cast<size_t>(INPUT_SIZE) * L1_SIZE)
+           && ReadArray(in, loaded->l2Biases, L2_SIZE)
+           && ReadArray(in, &loaded->l2Weights[0][0], L2_SIZE * 2 * L1_SIZE)
+           && ReadArray(in, loaded->l3Biases, L3_SIZE)
+           && ReadArray(in, &loaded->l3Weights[0][0], L3_SIZE * L2_SIZE)
+           && ReadArray(in, &loaded->outputBias, 1)
+           && ReadArray(in, loaded->outputWeights, L3_SIZE);
+    if (!ok || in.peek() != std::ifstream::traits_type::eof()) {
+        return fail(path + " has the wrong size for its header");
+    }
+
+    network = std::move(loaded);
+    return true;
+}
+
+bool IsLoaded() {
+    return network != nullptr;
+}
+
+const char* KernelName() {
+    return KERNELS.name;
+}
+
+void AddFeature(Accumulator& accumulator, Color perspective, int index) {
+    KERNELS.addColumn(accumulator.values[ColorIndex(perspective)], network->featureWeights[index]);
+}
+
+void RemoveFeature(Accumulator& accumulator, Color perspective, int index) {
+    KERNELS.subColumn(accumulator.values[ColorIndex(perspective)], network->featureWeights[index]);
+}
+
+void Refresh(const Board& board, Color perspective, Accumulator& accumulator) {
+    assert(network && board.Pieces(perspective, PieceType::KING));
+
+    int16_t* values = accumulator.values[ColorIndex(perspective)];
+    std::memcpy(values, network->featureBiases, sizeof(network->featureBiases));
+
+    int kingSq = Lsb(board.Pieces(perspective, PieceType::KING));
+    Bitboard pieces = board.Occupied() & ~board.Pieces(PieceType::KING);
+    while (pieces) {
+        int sq = PopLsb(pieces);
+        const Piece& piece = board.PieceOn(sq);
+        KERNELS.addColumn(values, network->featureWeights[FeatureIndex(perspective, kingSq, piece.color, piece.type, sq)]);
+    }
+    accumulator.computed[ColorIndex(perspective)] = true;
+}
+
+Value Evaluate(const Accumulator& accumulator, Color sideToMove) {
+    assert(network && accumulator.computed[0] && accumulator.computed[1]);
+
+    // The side to move's half always comes first
+    alignas(64) uint8_t input[2 * L1_SIZE];
+    KERNELS.clip(accumulator.values[ColorIndex(sideToMove)], input, L1_SIZE);
+    KERNELS.clip(accumulator.values[ColorIndex(Opponent(sideToMove))], input + L1_SIZE, L1_SIZE);
+
+    alignas(64) int32_t l2Sums[L2_SIZE];
+    alignas(64) uint8_t l2Output[L2_SIZE];
+    KERNELS.affine(input, 2 * L1_SIZE, &network->l2Weights[0][0], network->l2Biases, l2Sums, L2_SIZE);
+    ClipHidden(l2Sums, l2Output, L2_SIZE);
+
+    alignas(64) int32_t l3Sums[L3_SIZE];
+    alignas(64) uint8_t l3Output[L3_SIZE];
+    KERNELS.affine(l2Output, L2_SIZE, &network->l3Weights[0][0], network->l3Biases, l3Sums, L3_SIZE);
+    ClipHidden(l3Sums, l3Output, L3_SIZE);
+
+    int32_t output;
+    KERNELS.affine(l3Output, L3_SIZE, network->outputWeights, &network->outputBias, &output, 1);
+
+    // Keep clear of the mate range, which only the search may produce
+    return std::clamp(output / OUTPUT_SCALE, -VALUE_MATE_IN_MAX_PLY + 1, VALUE_MATE_IN_MAX_PLY - 1);
+}
+
+} // namespace NNUE
+} // namespace Chess
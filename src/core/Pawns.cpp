@@ -0,0 +1,167 @@
+#include "core/Pawns.h"
+#include "core/Board.h"
+#include <algorithm>
+
+namespace Chess {
+
+namespace {
+
+constexpr Score DOUBLED_PENALTY = { 10, 25 };    // Per pawn with a friendly pawn in front
+constexpr Score ISOLATED_PENALTY = { 10, 15 };   // No friendly pawn on either adjacent file
+constexpr Score BACKWARD_PENALTY = { 8, 12 };    // Left behind its neighbours, stop square under attack
+
+// Passed pawn bonus by relative rank (1 = starting rank)
+constexpr Score PASSED_BONUS[BOARD_SIZE] = {
+    { 0, 0 }, { 5, 10 }, { 10, 15 }, { 15, 25 }, { 25, 45 }, { 45, 75 }, { 70, 110 }, { 0, 0 }
+};
+
+// King shelter per file by how many ranks ahead of the king the nearest own pawn stands
+constexpr int SHELTER_BONUS[4] = { 0, 20, 10, 0 };
+constexpr int SHELTER_MISSING_PENALTY = 15;   // No own pawn within three ranks
+
+// Rank counted from color's own side, 0 = back rank
+constexpr int RelativeRow(Color c, int y) { return c == Color::WHITE ? BOARD_SIZE - 1 - y : y; }
+
+// Rows strictly ahead of row y from color's point of view (white advances towards row 0)
+constexpr Bitboard ForwardRows(Color c, int y) {
+    if (c == Color::WHITE) return (1ULL << (8 * y)) - 1;
+    return y == BOARD_SIZE - 1 ? 0 : ~((1ULL << (8 * (y + 1))) - 1);
+}
+
+constexpr Bitboard AdjacentFiles(int x) {
+    return (x > 0 ? FileBB(x - 1) : 0) | (x < BOARD_SIZE - 1 ? FileBB(x + 1) : 0);
+}
+
+constexpr Bitboard ForwardFile(Color c, int sq) {
+    return FileBB(SquareFile(sq)) & ForwardRows(c, SquareRow(sq));
+}
+
+constexpr Bitboard AttackSpan(Color c, int sq) {
+    return AdjacentFiles(SquareFile(sq)) & ForwardRows(c, SquareRow(sq));
+}
+
+constexpr Bitboard PassedSpan(Color c, int sq) {
+    return ForwardFile(c, sq) | AttackSpan(c, sq);
+}
+
+constexpr Bitboard PawnAttacksOf(Color c, Bitboard pawns) {
+    return c == Color::WHITE ? ((pawns & ~FILE_A_BB) >> 9) | ((pawns & ~FILE_H_BB) >> 7)
+                             : ((pawns & ~FILE_A_BB) << 7) | ((pawns & ~FILE_H_BB) << 9);
+}
+
+// Structure terms of one side's pawns, from that side's point of view
+Score EvaluateSide(const Board& board, Color us, PawnEntry& entry) {
+    Color them = Opponent(us);
+    Bitboard ourPawns = board.Pieces(us, PieceType::PAWN);
+    Bitboard theirPawns = board.Pieces(them, PieceType::PAWN);
+    Bitboard theirAttacks = PawnAttacksOf(them, theirPawns);
+    int c = ColorIndex(us);
+
+    entry.passedPawns[c] = 0;
+    entry.pawnAttacks[c] = PawnAttacksOf(us, ourPawns);
+    entry.pawnAttacksSpan[c] = 0;
+
+    Score score;
+    Bitboard pawns = ourPawns;
+    while (pawns) {
+        int sq = PopLsb(pawns);
+        int x = SquareFile(sq), y = SquareRow(sq);
+        int stopSquare = (us == Color::WHITE) ? sq - BOARD_SIZE : sq + BOARD_SIZE;
+
+        entry.pawnAttacksSpan[c] |= AttackSpan(us, sq);
+
+        Bitboard neighbours = ourPawns & AdjacentFiles(x);
+        if (ourPawns & ForwardFile(us, sq)) {
+            score -= DOUBLED_PENALTY;
+        }
+        if (!neighbours) {
+            score -= ISOLATED_PENALTY;
+        } else if (!(neighbours & ~ForwardRows(us, y)) && (theirAttacks & SquareBB(stopSquare))) {
+            // Every neighbour has advanced past it, and it cannot step up to them safely
+            score -= BACKWARD_PENALTY;
+        }
+
+        // Passed unless an enemy pawn can block or capture it on its way; of doubled
+        // pawns only the front one counts
+        if (!(theirPawns & PassedSpan(us, sq)) && !(ourPawns & ForwardFile(us, sq))) {
+            entry.passedPawns[c] |= SquareBB(sq);
+            score += PASSED_BONUS[RelativeRow(us, y)];
+        }
+    }
+    return score;
+}
+
+} // namespace
+
+Score PawnEntry::KingShelter(const Board& board, Color color) {
+    int c = ColorIndex(color);
+    Bitboard king = board.Pieces(color, PieceType::KING);
+    if (!king) return Score();
+
+    int kingSq = Lsb(king);
+    if (shelterKingSquare[c] == kingSq) {
+        return shelter[c];
+    }
+
+    // The king's file and its neighbours, shifted inwards on the edge files
+    int kingRow = RelativeRow(color, SquareRow(kingSq));
+    int center = std::clamp(SquareFile(kingSq), 1, BOARD_SIZE - 2);
+    Bitboard ourPawns = board.Pieces(color, PieceType::PAWN) & ForwardRows(color, SquareRow(kingSq));
+
+    int bonus = 0;
+    for (int x = center - 1; x <= center + 1; ++x) {
+        int nearest = BOARD_SIZE;
+        Bitboard filePawns = ourPawns & FileBB(x);
+        while (filePawns) {
+            nearest = std::min(nearest, RelativeRow(color, SquareRow(PopLsb(filePawns))) - kingRow);
+        }
+        bonus += nearest < 4 ? SHELTER_BONUS[nearest] : -SHELTER_MISSING_PENALTY;
+    }
+
+    shelterKingSquare[c] = kingSq;
+    shelter[c] = Score{ bonus, 0 };
+    return shelter[c];
+}
+
+void EvaluatePawns(const Board& board, PawnEntry& entry) {
+    entry.key = board.GetPawnKey();
+    entry.score = EvaluateSide(board, Color::WHITE, entry) - EvaluateSide(board, Color::BLACK, entry);
+    entry.shelterKingSquare[0] = entry.shelterKingSquare[1] = -1;
+}
+
+PawnTable::PawnTable(size_t entries) {
+    Resize(entries);
+}
+
+void PawnTable::Resize(size_t count) {
+    // Power-of-two size so the index is a mask of the key's low bits
+    size_t size = 1;
+    while (size * 2 <= count) {
+        size *= 2;
+    }
+    entries.assign(size, PawnEntry());
+    Clear();
+}
+
+PawnEntry* PawnTable::Probe(const Board& board) {
+    uint64_t key = board.GetPawnKey();
+    PawnEntry& entry = entries[key & (entries.size() - 1)];
+    ++probes;
+    if (entry.key == key) {
+        ++hits;
+        return &entry;
+    }
+    EvaluatePawns(board, entry);
+    return &entry;
+}
+
+void PawnTable::Clear() {
+    // Key 0 is the pawnless structure, so every slot starts out as a valid entry for it
+    Board empty;
+    for (PawnEntry& entry : entries) {
+        EvaluatePawns(empty, entry);
+    }
+    probes = hits = 0;
+}
+
+} // namespace Chess
@@ -105,4 +105,42 @@ std::string Move::ToUCI() const {
     return result;
 }
 
+// CompactMove implementation
+namespace {
+    constexpr PieceType PROMOTION_PIECES[4] = { PieceType::KNIGHT, PieceType::BISHOP, PieceType::ROOK, PieceType::QUEEN };
+
+    int PromotionCode(PieceType type) {
+        switch (type) {
+            case PieceType::BISHOP: return 1;
+            case PieceType::ROOK: return 2;
+            case PieceType::QUEEN: return 3;
+            default: return 0;
+        }
+    }
+}
+
+CompactMove::CompactMove(int from, int to, MoveType type, PieceType promotion)
+    : data(static_cast<uint16_t>(from | (to << 6) | (PromotionCode(promotion) << 12) | (static_cast<int>(type) << 14))) {
+}
+
+CompactMove::CompactMove(const Move& move)
+    : CompactMove(move.from.y * BOARD_SIZE + move.from.x, move.to.y * BOARD_SIZE + move.to.x, move.type,
+                  move.type == MoveType::PROMOTION ? move.promotionPiece : PieceType::KNIGHT) {
+    if (!move.IsValid()) data = 0;
+}
+
+PieceType CompactMove::Promotion() const {
+    return Type() == MoveType::PROMOTION ? PROMOTION_PIECES[(data >> 12) & 3] : PieceType::EMPTY;
+}
+
+Move CompactMove::ToMove() const {
+    if (!IsValid()) return Move();
+
+    Move move(Position(static_cast<int8_t>(From() % BOARD_SIZE), static_cast<int8_t>(From() / BOARD_SIZE)),
+              Position(static_cast<int8_t>(To() % BOARD_SIZE), static_cast<int8_t>(To() / BOARD_SIZE)),
+              Type());
+    move.promotionPiece = Promotion();
+    return move;
+}
+
 } // namespace Chess
\ No newline at end of file
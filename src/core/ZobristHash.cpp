@@ -0,0 +1,63 @@
+#include "core/ZobristHash.h"
+#include "core/Board.h"
+
+namespace Chess {
+
+bool ZobristHash::EnPassantMatters(const Board& board) {
+    Position enPassantPos = board.GetEnPassantTarget();
+    if (!enPassantPos.IsValid()) return false;
+
+    Color us = board.GetCurrentPlayer();
+    return (PawnAttacksFrom(Opponent(us), PositionToSquare(enPassantPos)) & board.Pieces(us, PieceType::PAWN)) != 0;
+}
+
+uint64_t ZobristHash::getHash(const Board& board) {
+    uint64_t hash = 0;
+    Bitboard occupied = board.Occupied();
+    while (occupied) {
+        int sq = PopLsb(occupied);
+        const Piece& piece = board.PieceOn(sq);
+        hash ^= PieceKey(piece.color, piece.type, sq);
+    }
+    if (board.GetCurrentPlayer() == Color::WHITE) {
+        hash ^= SideToMoveKey();
+    }
+    uint8_t castleRights = 0;
+    if (board.CanCastleKingSide(Color::WHITE)) castleRights |= WHITE_KING_SIDE;
+    if (board.CanCastleQueenSide(Color::WHITE)) castleRights |= WHITE_QUEEN_SIDE;
+    if (board.CanCastleKingSide(Color::BLACK)) castleRights |= BLACK_KING_SIDE;
+    if (board.CanCastleQueenSide(Color::BLACK)) castleRights |= BLACK_QUEEN_SIDE;
+    hash ^= CastleKey(castleRights);
+    if (EnPassantMatters(board)) {
+        hash ^= EnPassantKey(board.GetEnPassantTarget().x);
+    }
+    return hash;
+}
+
+uint64_t ZobristHash::getPawnHash(const Board& board) {
+    uint64_t hash = 0;
+    for (Color color : { Color::WHITE, Color::BLACK }) {
+        Bitboard pawns = board.Pieces(color, PieceType::PAWN);
+        while (pawns) {
+            hash ^= PieceKey(color, PieceType::PAWN, PopLsb(pawns));
+        }
+    }
+    return hash;
+}
+
+uint64_t ZobristHash::getMaterialHash(const Board& board) {
+    // One key per (color, piece type, index) for every piece on the board, so the
+    // key depends only on the piece counts
+    uint64_t hash = 0;
+    for (Color color : { Color::WHITE, Color::BLACK }) {
+        for (int p = static_cast<int>(PieceType::PAWN); p <= static_cast<int>(PieceType::KING); ++p) {
+            int count = PopCount(board.Pieces(color, static_cast<PieceType>(p)));
+            for (int i = 0; i < count; ++i) {
+                hash ^= PieceKey(color, static_cast<PieceType>(p), i);
+            }
+        }
+    }
+    return hash;
+}
+
+} // namespace Chess
@@ -0,0 +1,113 @@
+#include "engine/Bench.h"
+#include "engine/Engine.h"
+#include <chrono>
+#include <fmt/format.h>
+#include <ostream>
+#include <string>
+
+namespace Chess {
+
+namespace {
+
+const char* const BENCH_POSITIONS[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+    "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+    "r2q1rk1/pp2bppp/2n1pn2/3p4/3P4/2NBPN2/PP3PPP/R2Q1RK1 w - - 0 10",
+    "8/5pk1/6p1/8/3R4/6P1/5PK1/r7 w - - 0 40",
+};
+
+struct BenchResult {
+    uint64_t nodes = 0;
+    double seconds = 0.0;
+};
+
+BenchResult RunPositions(int threads, ParallelMode mode, int depth) {
+    // A fresh engine per run, so no backend profits from another's TT entries
+    Engine engine(TranspositionTable::DEFAULT_SIZE_MB, threads);
+    engine.setParallelMode(mode);
+    engine.setDepthLimit(depth);
+
+    // Fixed depth: give the time manager far more time than the search needs
+    TimeControl timeControl;
+    timeControl.baseTime = std::chrono::hours(24 * 30);
+    timeControl.increment = std::chrono::milliseconds(0);
+
+    BenchResult result;
+    for (const char* fen : BENCH_POSITIONS) {
+        Board board;
+        board.LoadFromFEN(fen);
+        engine.findBestMove(board, Difficulty::MASTER, timeControl);
+
+        const SearchStats& stats = engine.getLastSearchStats();
+        result.nodes += stats.nodes;
+        result.seconds += stats.time.count() / 1000.0;
+    }
+    return result;
+}
+
+// Evaluations after every legal move of every bench position, repeated passes times
+double EvalsPerSecond(bool useNnue, int passes) {
+    uint64_t evals = 0;
+    [[maybe_unused]] volatile Value sink = 0;   // Keeps the evaluations from being optimized away
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const char* fen : BENCH_POSITIONS) {
+            Board board;
+            board.LoadFromFEN(fen);
+            board.UseNnue(useNnue);
+
+            MoveList moves;
+            board.GenerateMoves(GenType::LEGAL, moves);
+            for (CompactMove move : moves) {
+                board.DoMove(move);
+                sink = board.Evaluate(board.GetCurrentPlayer());
+                board.UndoMove(move);
+                ++evals;
+            }
+        }
+    }
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+    return seconds.count() > 0.0 ? evals / seconds.count() : 0.0;
+}
+
+} // namespace
+
+void RunParallelBench(std::ostream& out, int threads, int depth) {
+    out << fmt::format("Parallel bench: {} positions, depth {}, {} threads\n",
+                       std::size(BENCH_POSITIONS), depth, threads);
+
+    BenchResult serial = RunPositions(1, ParallelMode::LAZY_SMP, depth);
+    out << fmt::format("{:<10} {:>8.2f}s {:>12} nodes\n", "serial", serial.seconds, serial.nodes);
+
+    const std::pair<const char*, ParallelMode> backends[] = {
+        { "lazy-smp", ParallelMode::LAZY_SMP },
+        { "ybwc", ParallelMode::YBWC },
+    };
+    for (const auto& [name, mode] : backends) {
+        BenchResult parallel = RunPositions(threads, mode, depth);
+        double speedup = parallel.seconds > 0.0 ? serial.seconds / parallel.seconds : 0.0;
+        double overhead = serial.nodes ? 100.0 * (static_cast<double>(parallel.nodes) / serial.nodes - 1.0) : 0.0;
+        out << fmt::format("{:<10} {:>8.2f}s {:>12} nodes  speedup {:.2f}x  overhead {:+.1f}%\n",
+                           name, parallel.seconds, parallel.nodes, speedup, overhead);
+    }
+}
+
+void RunEvalBench(std::ostream& out, const std::string& networkPath) {
+    constexpr int PASSES = 2000;
+
+    out << fmt::format("{:<20} {:>14.0f} evals/s\n", "classical", EvalsPerSecond(false, PASSES));
+
+    if (networkPath.empty()) {
+        return;
+    }
+    std::string error;
+    if (!NNUE::LoadNetwork(networkPath, &error)) {
+        out << fmt::format("nnue: {}\n", error);
+        return;
+    }
+    std::string name = fmt::format("nnue ({})", NNUE::KernelName());
+    out << fmt::format("{:<20} {:>14.0f} evals/s\n", name, EvalsPerSecond(true, PASSES));
+}
+
+} // namespace Chess
@@ -1,271 +1,1036 @@
 #include "engine/Engine.h"
-#include "engine/ZobristHash.h"
 #include <iostream>
 #include <algorithm>
-#include <unordered_map>
-#include <random>
+#include <cmath>
+#include <thread>
 
 namespace Chess {
 
-// ZobristHash implementation
-uint64_t ZobristHash::randomUInt64() {
-    std::mt19937_64 rng(std::random_device{}());
-    return rng();
+namespace {
+
+// Lazy SMP depth skipping: helper i skips the iterations where
+// ((depth + SKIP_PHASE[i]) / SKIP_SIZE[i]) is odd, so helpers spread over
+// different depths instead of all racing through the same one.
+constexpr int SKIP_SIZE[] = { 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 4, 4, 4, 4, 4, 4, 4, 4 };
+constexpr int SKIP_PHASE[] = { 0, 1, 0, 1, 2, 3, 0, 1, 2, 3, 4, 5, 0, 1, 2, 3, 4, 5, 6, 7 };
+constexpr int SKIP_PATTERNS = sizeof(SKIP_SIZE) / sizeof(SKIP_SIZE[0]);
+
+// Base late move reduction by depth and move number, both capped at 63:
+// 0.75 + log(depth) * log(moveNumber) / 2.25, so late moves at deep nodes lose the most
+constexpr int LMR_TABLE_SIZE = 64;
+const auto LMR_TABLE = [] {
+    std::array<std::array<int, LMR_TABLE_SIZE>, LMR_TABLE_SIZE> table{};
+    for (int depth = 1; depth < LMR_TABLE_SIZE; ++depth) {
+        for (int moveNumber = 1; moveNumber < LMR_TABLE_SIZE; ++moveNumber) {
+            table[depth][moveNumber] = static_cast<int>(0.75 + std::log(depth) * std::log(moveNumber) / 2.25);
+        }
+    }
+    return table;
+}();
+
+bool IsQuiet(const Board& board, CompactMove move) {
+    return board.PieceOn(move.To()).IsEmpty()
+        && move.Type() != MoveType::EN_PASSANT
+        && move.Type() != MoveType::PROMOTION;
 }
 
-ZobristHash::ZobristHash() {
-    generate();
+} // namespace
+
+// Engine implementation
+Engine::Engine(size_t hashSizeMB, int threadCount)
+    : transpositionTable(hashSizeMB), stopSearch(false),
+      parallelMode(ParallelMode::LAZY_SMP), evalType(EvalType::CLASSICAL), depthLimit(0),
+      pawnTableEntries(PawnTable::DEFAULT_ENTRIES), idleThreads(0), splitGeneration(0) {
+    setThreads(threadCount);
 }
 
-void ZobristHash::generate() {
-    std::mt19937_64 rng(std::random_device{}());
-    for (int c = 0; c < NUM_COLORS; ++c) {
-        for (int p = 0; p < NUM_PIECE_TYPES; ++p) {
-            for (int s = 0; s < NUM_SQUARES; ++s) {
-                pieceKeys[c][p][s] = rng();
-            }
+void Engine::setThreads(int threadCount) {
+    threads.resize(std::max(threadCount, 1));
+    for (size_t i = 0; i < threads.size(); ++i) {
+        threads[i].id = static_cast<int>(i);
+        if (threads[i].pawnTable.Size() != pawnTableEntries) {
+            threads[i].pawnTable.Resize(pawnTableEntries);
+        }
+    }
+    splitQueues = std::make_unique<SplitQueue[]>(threads.size());
+}
+
+void Engine::setPawnTableSize(size_t entries) {
+    for (SearchThread& thread : threads) {
+        thread.pawnTable.Resize(entries);
+    }
+    pawnTableEntries = threads[0].pawnTable.Size();
+}
+
+/**
+ * The main entry point for the AI to find a move.
+ * It uses iterative deepening to search the board, on every thread at once.
+ */
+Move Engine::findBestMove(const Board& board, Difficulty difficulty, const TimeControl& timeControl) {
+    timeManager.Init(timeControl);
+
+    // The main thread searches this copy
+    Board root = board;
+    root.UseNnue(evalType == EvalType::NNUE && NNUE::IsLoaded());
+    transpositionTable.NewSearch();
+    stopSearch = false;
+
+    for (SearchThread& thread : threads) {
+        thread.bestMove = CompactMove();
+        thread.bestScore = 0;
+        thread.completedDepth = 0;
+        thread.nodes = 0;
+        thread.splits = 0;
+        thread.nullMoveMinPly = 0;
+        thread.killerMoves = {};
+        thread.splitPoint = nullptr;
+        thread.pawnTable.ResetCounters();
+    }
+    idleThreads = 0;
+
+    // Helpers get their own copy of the board; only the TT is shared
+    std::vector<std::thread> helpers;
+    for (size_t i = 1; i < threads.size(); ++i) {
+        if (parallelMode == ParallelMode::YBWC) {
+            helpers.emplace_back(&Engine::splitPointWorker, this, std::ref(threads[i]));
+        } else {
+            helpers.emplace_back([this, root, &thread = threads[i]]() mutable { iterativeDeepening(root, thread); });
         }
     }
-    sideToMoveKey = rng();
-    for (int i = 0; i < 16; ++i) {
-        castleKeys[i] = rng();
+    iterativeDeepening(root, threads[0]);
+
+    stopSearch = true;
+    wakeIdleThreads(false);
+    for (std::thread& helper : helpers) {
+        helper.join();
     }
-    for (int i = 0; i < 8; ++i) {
-        enPassantKeys[i] = rng();
+
+    lastStats = SearchStats();
+    lastStats.depth = threads[0].completedDepth;
+    lastStats.time = timeManager.Elapsed();
+    for (const SearchThread& thread : threads) {
+        lastStats.threadNodes.push_back(thread.nodes);
+        lastStats.nodes += thread.nodes;
+        lastStats.splits += thread.splits;
+        lastStats.pawnProbes += thread.pawnTable.Probes();
+        lastStats.pawnHits += thread.pawnTable.Hits();
     }
+
+    return board.ToMove(voteBestThread().bestMove);
 }
 
-uint64_t ZobristHash::getHash(const Board& board) {
-    uint64_t hash = 0;
-    for (int y = 0; y < BOARD_SIZE; ++y) {
-        for (int x = 0; x < BOARD_SIZE; ++x) {
-            const Piece& piece = board.GetPiece(x, y);
-            if (!piece.IsEmpty()) {
-                int colorIdx = (piece.color == Color::WHITE) ? 0 : 1;
-                int pieceIdx = static_cast<int>(piece.type);
-                hash ^= pieceKeys[colorIdx][pieceIdx][y * 8 + x];
+void Engine::iterativeDeepening(Board& board, SearchThread& thread) {
+    int maxDepth = depthLimit > 0 ? depthLimit : MAX_SEARCH_DEPTH;
+    for (int depth = 1; depth <= maxDepth; ++depth) {
+        if (thread.id > 0) {
+            int pattern = (thread.id - 1) % SKIP_PATTERNS;
+            if (((depth + SKIP_PHASE[pattern]) / SKIP_SIZE[pattern]) % 2) {
+                continue;
             }
         }
+
+        MoveList moves;
+        board.GenerateMoves(GenType::LEGAL, moves);
+        if (moves.Empty()) {
+            return;
+        }
+
+        // The previous iteration's best move goes first
+        orderMoves(thread, board, moves, thread.bestMove);
+
+        // Helpers also visit the root moves in a different order behind the first
+        if (thread.id > 0 && moves.Size() > 2) {
+            size_t shift = static_cast<size_t>(thread.id) % (moves.Size() - 1);
+            std::rotate(moves.begin() + 1, moves.begin() + 1 + shift, moves.end());
+        }
+
+        // Aspiration window around the last score, widened each time the search falls outside it
+        int delta = ASPIRATION_WINDOW;
+        Value alpha = -VALUE_INFINITE;
+        Value beta = VALUE_INFINITE;
+        if (depth >= ASPIRATION_MIN_DEPTH && thread.completedDepth > 0) {
+            alpha = std::max(thread.bestScore - delta, -VALUE_INFINITE);
+            beta = std::min(thread.bestScore + delta, VALUE_INFINITE);
+        }
+
+        Value score;
+        CompactMove currentBestMove;
+        while (true) {
+            CompactMove move;
+            bool finished = searchRoot(thread, board, moves, depth, alpha, beta, score, move);
+            if (move.IsValid() && score > alpha) {
+                currentBestMove = move;
+            }
+            if (!finished) {
+                // A stopped iteration is discarded and the last completed one stands. Only
+                // if none completed, fall back to the best root move searched to the end.
+                if (!thread.bestMove.IsValid()) {
+                    thread.bestMove = currentBestMove.IsValid() ? currentBestMove : moves[0];
+                }
+                return;
+            }
+
+            if (score <= alpha) {
+                beta = (alpha + beta) / 2;
+                alpha = std::max(score - delta, -VALUE_INFINITE);
+            } else if (score >= beta) {
+                beta = std::min(score + delta, VALUE_INFINITE);
+            } else {
+                break;
+            }
+            delta += delta / 2;
+        }
+
+        CompactMove previousBestMove = thread.bestMove;
+        thread.bestScore = score;
+        thread.bestMove = currentBestMove.IsValid() ? currentBestMove : moves[0];
+        thread.completedDepth = depth;
+
+        // The main thread decides when the search has had enough time; helpers follow it
+        if (thread.id == 0) {
+            double nodeShare = thread.rootNodes ? static_cast<double>(thread.bestMoveNodes) / thread.rootNodes : 0.0;
+            if (timeManager.ShouldStopAfterIteration(thread.bestMove != previousBestMove, score, nodeShare)) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * Searches the root moves in order with principal variation search: the first
+ * move with the full window, the rest with a null window around alpha, re-searched
+ * with the full window only if they beat it. Returns false if the search was stopped,
+ * in which case bestScore and bestMove only reflect the moves searched to the end.
+ */
+bool Engine::searchRoot(SearchThread& thread, Board& board, const MoveList& moves, int depth,
+                        Value alpha, Value beta, Value& bestScore, CompactMove& bestMove) {
+    bestScore = -VALUE_INFINITE;
+    bestMove = CompactMove();
+    uint64_t startNodes = thread.nodes;
+    thread.bestMoveNodes = 0;
+
+    for (size_t i = 0; i < moves.Size(); ++i) {
+        CompactMove move = moves[i];
+        uint64_t moveStartNodes = thread.nodes;
+        board.DoMove(move);
+        transpositionTable.Prefetch(board.GetKey());
+        Value score;
+        if (i == 0) {
+            score = -alphaBeta(thread, board, depth - 1, 1, -beta, -alpha);
+        } else {
+            score = -alphaBeta(thread, board, depth - 1, 1, -alpha - 1, -alpha);
+            if (score > alpha && score < beta) {
+                score = -alphaBeta(thread, board, depth - 1, 1, -beta, -alpha);
+            }
+        }
+        board.UndoMove(move);
+
+        if (stopped()) {
+            return false;
+        }
+
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
+            thread.bestMoveNodes = thread.nodes - moveStartNodes;
+            if (score > alpha) {
+                alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+    thread.rootNodes = thread.nodes - startNodes;
+    return true;
+}
+
+/**
+ * Chooses among the threads' moves. Each thread votes for its best move with a
+ * weight growing with both its score and the depth it completed, so a deep
+ * helper can outvote a main thread that stopped an iteration early.
+ */
+const Engine::SearchThread& Engine::voteBestThread() const {
+    const SearchThread* best = &threads[0];
+    if (threads.size() == 1) {
+        return *best;
+    }
+
+    int minScore = std::numeric_limits<int>::max();
+    for (const SearchThread& thread : threads) {
+        if (thread.completedDepth > 0) {
+            minScore = std::min(minScore, thread.bestScore);
+        }
     }
-    if (board.GetCurrentPlayer() == Color::WHITE) {
-        hash ^= sideToMoveKey;
+
+    std::vector<std::pair<CompactMove, int64_t>> votes;
+    for (const SearchThread& thread : threads) {
+        if (thread.completedDepth == 0 || !thread.bestMove.IsValid()) continue;
+
+        int64_t weight = static_cast<int64_t>(thread.bestScore - minScore + 14) * thread.completedDepth;
+        auto it = std::find_if(votes.begin(), votes.end(),
+            [&](const auto& vote) { return vote.first == thread.bestMove; });
+        if (it == votes.end()) {
+            votes.emplace_back(thread.bestMove, weight);
+        } else {
+            it->second += weight;
+        }
     }
-    uint8_t castleRights = 0;
-    if (board.CanCastleKingSide(Color::WHITE)) castleRights |= 1;
-    if (board.CanCastleQueenSide(Color::WHITE)) castleRights |= 2;
-    if (board.CanCastleKingSide(Color::BLACK)) castleRights |= 4;
-    if (board.CanCastleQueenSide(Color::BLACK)) castleRights |= 8;
-    hash ^= castleKeys[castleRights];
-    Position enPassantPos = board.GetEnPassantTarget();
-    if (enPassantPos.IsValid()) {
-        hash ^= enPassantKeys[enPassantPos.x];
+
+    int64_t bestVotes = -1;
+    for (const SearchThread& thread : threads) {
+        if (thread.completedDepth == 0 || !thread.bestMove.IsValid()) continue;
+
+        auto it = std::find_if(votes.begin(), votes.end(),
+            [&](const auto& vote) { return vote.first == thread.bestMove; });
+        if (it->second > bestVotes) {
+            bestVotes = it->second;
+            best = &thread;
+        }
     }
-    return hash;
+    return *best;
 }
 
-// Engine implementation
-Engine::Engine() {
-    for (int i = 0; i < BOARD_SIZE; ++i) {
-        for (int j = 0; j < BOARD_SIZE; ++j) {
-            historyHeuristic[i][j] = 0;
+/**
+ * YBWC helper loop: waits for split points published by other threads and joins them.
+ */
+void Engine::splitPointWorker(SearchThread& thread) {
+    ++idleThreads;
+    while (!stopped()) {
+        // Read before looking, so a split point published after the look is not slept through
+        uint64_t seen = splitGeneration.load();
+        SplitPoint* splitPoint = stealSplitPoint(thread);
+        if (!splitPoint) {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCondition.wait(lock, [&] { return stopped() || splitGeneration.load() != seen; });
+            continue;
         }
+
+        --idleThreads;
+        Board board = splitPoint->board;
+        searchSplitPoint(thread, *splitPoint, board);
+        ++idleThreads;
     }
+    --idleThreads;
+}
+
+bool Engine::canSplit(int depth) const {
+    return parallelMode == ParallelMode::YBWC
+        && threads.size() > 1
+        && depth >= YBWC_MIN_SPLIT_DEPTH
+        && idleThreads.load(std::memory_order_relaxed) > 0
+        && !stopped();
 }
 
 /**
- * The main entry point for the AI to find a move.
- * It uses iterative deepening to search the board.
+ * Publishes the moves from firstMove on as a split point, searches them together
+ * with any helpers that join, and folds the shared result back into the caller's
+ * search window.
  */
-Move Engine::findBestMove(Board board, Difficulty difficulty, const TimeControl& timeControl) {
-    startTime = std::chrono::steady_clock::now();
+void Engine::split(SearchThread& thread, Board& board, const MoveList& moves, size_t firstMove, int depth, int ply,
+                   bool pvNode, bool improving, Value& alpha, Value beta, Value& bestScore, CompactMove& bestMove,
+                   int& legalMoves, CompactMove* quietsTried, int& quietCount) {
+    auto splitPoint = std::make_unique<SplitPoint>();
+    SplitPoint& sp = *splitPoint;
+    sp.board = board;
+    sp.parent = thread.splitPoint;
+    sp.moves = moves;
+    sp.nextMove = firstMove;
+    sp.depth = depth;
+    sp.ply = ply;
+    sp.pvNode = pvNode;
+    sp.improving = improving;
+    sp.staticEvals[0] = ply > 0 ? thread.staticEvals[ply - 1] : -VALUE_INFINITE;
+    sp.staticEvals[1] = thread.staticEvals[ply];
+    sp.alpha = alpha;
+    sp.beta = beta;
+    sp.score = bestScore;
+    sp.bestMove = bestMove;
+    sp.legalMoves = legalMoves;
+    std::copy(quietsTried, quietsTried + quietCount, sp.quietsTried.begin());
+    sp.quietCount = quietCount;
+    sp.cutoff = false;
+    sp.activeThreads = 1;   // The owner
+
+    SplitQueue& queue = splitQueues[thread.id];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.splitPoints.push_back(&sp);
+    }
+    wakeIdleThreads(true);
+    ++thread.splits;
+
+    searchSplitPoint(thread, sp, board);
+
+    // Withdraw the split point so no one else joins. Until the helpers still in it are
+    // done, help them with the split points they publish, or sleep.
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.splitPoints.erase(std::find(queue.splitPoints.begin(), queue.splitPoints.end(), &sp));
+    }
+    ++idleThreads;
+    while (sp.activeThreads.load() > 0) {
+        uint64_t seen = splitGeneration.load();
+        if (SplitPoint* child = stealSplitPoint(thread, &sp)) {
+            --idleThreads;
+            Board childBoard = child->board;
+            searchSplitPoint(thread, *child, childBoard);
+            ++idleThreads;
+            continue;
+        }
 
-    // Use adaptive time allocation
-    auto totalTime = timeControl.baseTime + timeControl.increment * (board.GetFullMoveNumber() - 1);
-    timeLimit = totalTime / 30; // Allocate a portion of total time for the move
-    if (timeLimit < std::chrono::milliseconds(100)) timeLimit = std::chrono::milliseconds(100);
+        auto wake = [&] { return sp.activeThreads.load() == 0 || splitGeneration.load() != seen; };
+        if (thread.id == 0) {
+            checkTime();
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCondition.wait_for(lock, IDLE_TIME_CHECK, wake);
+        } else {
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idleCondition.wait(lock, wake);
+        }
+    }
+    --idleThreads;
 
-    Move bestMove;
-    int bestScore = std::numeric_limits<int>::min();
+    alpha = sp.alpha;
+    bestScore = sp.score;
+    bestMove = sp.bestMove;
+    legalMoves = sp.legalMoves;
+    std::copy(sp.quietsTried.begin(), sp.quietsTried.begin() + sp.quietCount, quietsTried);
+    quietCount = sp.quietCount;
+}
 
-    // We will search up to depth 6, or more if time permits.
-    for (int depth = 1; depth <= 12; ++depth) {
-        std::vector<Move> legalMoves = board.GetAllLegalMoves(board.GetCurrentPlayer());
-        auto orderedMoves = orderMoves(board, legalMoves);
+/**
+ * Takes moves from a split point one at a time until none are left or the node
+ * has been refuted. board must be the split point's position.
+ */
+void Engine::searchSplitPoint(SearchThread& thread, SplitPoint& sp, Board& board) {
+    SplitPoint* previous = thread.splitPoint;
+    thread.splitPoint = &sp;
 
-        int currentBestScore = std::numeric_limits<int>::min();
-        Move currentBestMove;
+    // Children compare their static eval against these to tell if they are improving
+    if (sp.ply > 0) {
+        thread.staticEvals[sp.ply - 1] = sp.staticEvals[0];
+    }
+    thread.staticEvals[sp.ply] = sp.staticEvals[1];
+    bool inCheck = board.InCheck();
 
-        for (const auto& move : orderedMoves) {
-            if (timeIsUp()) {
-                goto end_search;
+    while (!sp.cutoff.load(std::memory_order_relaxed) && !cutoffAbove(thread)) {
+        size_t index = sp.nextMove++;
+        if (index >= sp.moves.Size()) {
+            break;
+        }
+
+        CompactMove move = sp.moves[index];
+        if (!board.IsLegal(move)) continue;
+
+        bool quiet = IsQuiet(board, move);
+        bool givesCheck = board.GivesCheck(move);
+
+        Value alpha, score;
+        int quietCount, moveNumber;
+        {
+            std::lock_guard<std::mutex> lock(sp.mutex);
+            alpha = sp.alpha;
+            score = sp.score;
+            quietCount = sp.quietCount;
+            moveNumber = sp.legalMoves + 1;
+        }
+
+        // Same pruning as alphaBeta. Quiet moves count as tried once taken, so threads
+        // searching in parallel see each other's moves against the late move limit.
+        bool lateMove;
+        bool pruned = !inCheck && !givesCheck && score > -VALUE_MATE_IN_MAX_PLY
+            && pruneMove(board, move, quiet, sp.depth, sp.improving, sp.staticEvals[1], alpha, quietCount, lateMove);
+        if (pruned || quiet) {
+            std::lock_guard<std::mutex> lock(sp.mutex);
+            if (pruned) {
+                ++sp.legalMoves;
+            } else if (sp.quietCount < MAX_QUIETS_TRIED) {
+                sp.quietsTried[sp.quietCount++] = move;
             }
-            Board tempBoard = board;
-            if (tempBoard.MakeMove(move)) {
-                int score = -alphaBeta(tempBoard, depth - 1, -std::numeric_limits<int>::max(), std::numeric_limits<int>::max());
-                if (score > currentBestScore) {
-                    currentBestScore = score;
-                    currentBestMove = move;
+        }
+        if (pruned) continue;
+
+        // Same reductions as alphaBeta, numbering moves by those already done at the node
+        board.DoMove(move);
+        transpositionTable.Prefetch(board.GetKey());
+        int reduction = 0;
+        if (sp.depth >= LMR_MIN_DEPTH && quiet && !inCheck && !givesCheck) {
+            reduction = lateMoveReduction(sp.depth, moveNumber)
+                      + !sp.improving - sp.pvNode
+                      - thread.historyHeuristic[ColorIndex(sp.board.GetCurrentPlayer())][move.From()][move.To()] / (HISTORY_MAX / 2);
+            reduction = std::clamp(reduction, 0, sp.depth - 2);
+        }
+        Value eval = searchLateMove(thread, board, sp.depth - 1, sp.ply, alpha, sp.beta, reduction);
+        board.UndoMove(move);
+
+        if (sp.cutoff.load(std::memory_order_relaxed) || cutoffAbove(thread) || stopped()) {
+            break;   // eval may come from an aborted subtree
+        }
+
+        std::lock_guard<std::mutex> lock(sp.mutex);
+        ++sp.legalMoves;
+        if (eval > sp.score) {
+            sp.score = eval;
+            sp.bestMove = move;
+            if (eval > sp.alpha) {
+                sp.alpha = eval;
+                if (eval >= sp.beta) {
+                    sp.cutoff = true;
                 }
             }
         }
-        bestScore = currentBestScore;
-        bestMove = currentBestMove;
     }
 
-end_search:
-    return bestMove;
+    thread.splitPoint = previous;
+    if (--sp.activeThreads == 0) {
+        wakeIdleThreads(false);   // The owner may be asleep waiting for the last helper
+    }
 }
 
 /**
- * Implements the Minimax algorithm with Alpha-Beta pruning.
+ * Finds a split point of another thread that still has moves to hand out and
+ * registers the caller in it. Oldest split points are preferred, they are the
+ * shallowest and so carry the most work. With within set, only split points below
+ * it qualify: an owner waiting for its helpers must not get stuck in unrelated work.
  */
-int Engine::alphaBeta(Board& board, int depth, int alpha, int beta) {
-    uint64_t hash = zobrist.getHash(board);
-    if (transpositionTable.count(hash)) {
-        const auto& entry = transpositionTable.at(hash);
-        if (entry.depth >= depth) {
-            if (entry.bound == TranspositionEntry::BoundType::EXACT) {
-                return entry.score;
-            }
-            if (entry.bound == TranspositionEntry::BoundType::LOWERBOUND) {
-                alpha = std::max(alpha, entry.score);
+Engine::SplitPoint* Engine::stealSplitPoint(const SearchThread& thread, const SplitPoint* within) {
+    auto below = [within](const SplitPoint* sp) {
+        for (const SplitPoint* parent = sp->parent; parent; parent = parent->parent) {
+            if (parent == within) {
+                return true;
             }
-            if (entry.bound == TranspositionEntry::BoundType::UPPERBOUND) {
-                beta = std::min(beta, entry.score);
-            }
-            if (alpha >= beta) {
-                return entry.score;
+        }
+        return false;
+    };
+
+    for (size_t k = 1; k < threads.size(); ++k) {
+        SplitQueue& queue = splitQueues[(thread.id + k) % threads.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        for (SplitPoint* sp : queue.splitPoints) {
+            if (!sp->cutoff.load(std::memory_order_relaxed) && sp->nextMove.load() < sp->moves.Size()
+                && (!within || below(sp))) {
+                ++sp->activeThreads;
+                return sp;
             }
         }
     }
+    return nullptr;
+}
 
-    if (depth == 0 || board.GetGameResult() != GameResult::ONGOING) {
-        return quiescenceSearch(board, alpha, beta);
+/**
+ * Wakes every thread sleeping on idleCondition to test its condition again. Taking
+ * idleMutex orders the change before the test of any thread about to sleep.
+ */
+void Engine::wakeIdleThreads(bool published) {
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        if (published) {
+            ++splitGeneration;
+        }
     }
+    idleCondition.notify_all();
+}
 
-    std::vector<Move> legalMoves = board.GetAllLegalMoves(board.GetCurrentPlayer());
-    if (legalMoves.empty()) {
-        return static_cast<int>(board.EvaluatePosition(board.GetCurrentPlayer()));
+bool Engine::cutoffAbove(const SearchThread& thread) {
+    for (const SplitPoint* sp = thread.splitPoint; sp; sp = sp->parent) {
+        if (sp->cutoff.load(std::memory_order_relaxed)) {
+            return true;
+        }
     }
+    return false;
+}
 
-    int score;
-    Move bestMoveThisDepth;
+/**
+ * Negamax alpha-beta search. Scores are relative to the side to move, so every
+ * node maximizes and a child's score is negated on the way up.
+ */
+Value Engine::alphaBeta(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta) {
+    // Stopped, or another thread refuted a node above us: nothing found here can matter
+    if (visitNode(thread) || cutoffAbove(thread)) {
+        return 0;
+    }
 
-    if (board.GetCurrentPlayer() == Color::WHITE) {
-        score = std::numeric_limits<int>::min();
-        auto orderedMoves = orderMoves(board, legalMoves);
-        for (const auto& move : orderedMoves) {
-            Board tempBoard = board;
-            if (tempBoard.MakeMove(move)) {
-                int eval = alphaBeta(tempBoard, depth - 1, alpha, beta);
-                if (eval > score) {
-                    score = eval;
-                    bestMoveThisDepth = move;
+    // Any repetition inside the search is scored as a draw, since the side that
+    // repeated could keep doing so
+    if (board.IsRepetition() || board.GetHalfMoveClock() >= 100 || board.IsInsufficientMaterial()) {
+        return VALUE_DRAW;
+    }
+
+    if (ply >= MAX_PLY) {
+        return board.Evaluate(board.GetCurrentPlayer(), &thread.pawnTable);
+    }
+
+    // Mate distance pruning: no line from here can beat a mate already found closer to the root
+    alpha = std::max(alpha, MatedIn(ply));
+    beta = std::min(beta, MateIn(ply + 1));
+    if (alpha >= beta) {
+        return alpha;
+    }
+
+    TTEntry entry;
+    bool ttHit = transpositionTable.Probe(board.GetKey(), entry);
+    if (ttHit && entry.Depth() >= depth) {
+        Value ttScore = scoreFromTT(entry.Score(), ply);
+        if (entry.Bound() == BoundType::EXACT
+            || (entry.Bound() == BoundType::LOWERBOUND && ttScore >= beta)
+            || (entry.Bound() == BoundType::UPPERBOUND && ttScore <= alpha)) {
+            return ttScore;
+        }
+    }
+
+    if (depth <= 0) {
+        return quiescenceSearch(thread, board, 0, ply, alpha, beta);
+    }
+
+    bool pvNode = beta - alpha > 1;
+    bool inCheck = board.InCheck();
+    Color us = board.GetCurrentPlayer();
+
+    // Improving: our static eval is better than at our previous move. Pruning is then
+    // riskier, since the line is heading somewhere.
+    Value staticEval = inCheck ? -VALUE_INFINITE : board.Evaluate(us, &thread.pawnTable);
+    thread.staticEvals[ply] = staticEval;
+    bool improving = !inCheck && ply >= 2 && staticEval > thread.staticEvals[ply - 2];
+
+    // Null-move pruning: if passing the turn still fails high, a real move almost surely
+    // will too. Not in check, not twice in a row, and not with only pawns left, where
+    // zugzwang makes passing an illusory advantage.
+    if (!pvNode && !inCheck && depth >= NULL_MOVE_MIN_DEPTH && ply >= thread.nullMoveMinPly
+        && !board.LastMoveWasNull() && std::abs(beta) < VALUE_MATE_IN_MAX_PLY
+        && (board.Pieces(us) & ~(board.Pieces(us, PieceType::PAWN) | board.Pieces(us, PieceType::KING)))) {
+        if (staticEval >= beta) {
+            int reduction = 3 + depth / 4 + std::min((staticEval - beta) / 200, 3);
+            int nullDepth = std::max(depth - reduction, 0);
+
+            board.DoNullMove();
+            Value nullScore = -alphaBeta(thread, board, nullDepth, ply + 1, -beta, -beta + 1);
+            board.UndoNullMove();
+
+            if (stopped()) {
+                return 0;
+            }
+
+            if (nullScore >= beta) {
+                // Do not return unproven mates
+                if (nullScore >= VALUE_MATE_IN_MAX_PLY) {
+                    nullScore = beta;
                 }
-                alpha = std::max(alpha, eval);
-                if (beta <= alpha) {
-                    break;
+                // Inside a verification search the outer one already guards against
+                // zugzwang; a nested one would lift its restriction when done
+                if (depth < NULL_MOVE_VERIFY_DEPTH || thread.nullMoveMinPly != 0) {
+                    return nullScore;
+                }
+
+                // At high depth, confirm with a reduced search of our own moves, with null
+                // moves disabled for the first part of it
+                thread.nullMoveMinPly = ply + 3 * nullDepth / 4;
+                Value verified = alphaBeta(thread, board, nullDepth, ply, beta - 1, beta);
+                thread.nullMoveMinPly = 0;
+                if (verified >= beta) {
+                    return nullScore;
                 }
             }
         }
-    } else {
-        score = std::numeric_limits<int>::max();
-        auto orderedMoves = orderMoves(board, legalMoves);
-        for (const auto& move : orderedMoves) {
-            Board tempBoard = board;
-            if (tempBoard.MakeMove(move)) {
-                int eval = alphaBeta(tempBoard, depth - 1, alpha, beta);
-                if (eval < score) {
-                    score = eval;
-                    bestMoveThisDepth = move;
-                }
-                beta = std::min(beta, eval);
-                if (beta <= alpha) {
+    }
+
+    // Pseudo-legal moves, generated stage by stage; legality is only checked for the
+    // moves actually searched
+    PieceToHistory* contHistory[2];
+    continuationTables(thread, board, contHistory);
+    CompactMove previous = board.PreviousMove();
+    CompactMove counterMove = previous.IsValid()
+        ? thread.counterMoves[PieceIndex(board.PieceOn(previous.To()))][previous.To()] : CompactMove();
+    MovePicker picker(board, ttHit ? entry.Move() : CompactMove(), thread.killerMoves[ply].data(), counterMove,
+                      thread.historyHeuristic, contHistory);
+
+    int originalAlpha = alpha;
+    Value bestScore = -VALUE_INFINITE;
+    CompactMove bestMoveThisDepth;
+    int legalMoves = 0;
+    std::array<CompactMove, MAX_QUIETS_TRIED> quietsTried;
+    int quietCount = 0;
+
+    CompactMove move;
+    while ((move = picker.NextMove()).IsValid()) {
+        if (!board.IsLegal(move)) continue;
+        ++legalMoves;
+
+        bool quiet = IsQuiet(board, move);
+        bool canPrune = !inCheck && bestScore > -VALUE_MATE_IN_MAX_PLY;
+
+        bool givesCheck = board.GivesCheck(move);
+
+        // Shallow pruning, once a move has been searched so there is a score to fall
+        // back on. Checks and evasions are always searched.
+        bool lateMove;
+        if (canPrune && !givesCheck
+            && pruneMove(board, move, quiet, depth, improving, staticEval, alpha, quietCount, lateMove)) {
+            if (lateMove) {
+                picker.SkipQuiets();
+            }
+            continue;
+        }
+
+        board.DoMove(move);
+        transpositionTable.Prefetch(board.GetKey());
+        Value eval;
+        if (legalMoves == 1) {
+            eval = -alphaBeta(thread, board, depth - 1, ply + 1, -beta, -alpha);
+        } else {
+            // Late move reductions: quiet moves far down the ordered list are searched
+            // shallower, less so at PV nodes, for checks and for moves with good history
+            int reduction = 0;
+            if (depth >= LMR_MIN_DEPTH && quiet && !inCheck && !givesCheck) {
+                reduction = lateMoveReduction(depth, legalMoves) + !improving - pvNode
+                          - thread.historyHeuristic[ColorIndex(us)][move.From()][move.To()] / (HISTORY_MAX / 2);
+                reduction = std::clamp(reduction, 0, depth - 2);
+            }
+            eval = searchLateMove(thread, board, depth - 1, ply, alpha, beta, reduction);
+        }
+        board.UndoMove(move);
+
+        if (stopped()) {
+            return 0;
+        }
+
+        if (quiet && quietCount < MAX_QUIETS_TRIED && eval < beta) {
+            quietsTried[quietCount++] = move;
+        }
+        if (eval > bestScore) {
+            bestScore = eval;
+            bestMoveThisDepth = move;
+            if (eval > alpha) {
+                alpha = eval;
+                if (alpha >= beta) {
                     break;
                 }
             }
         }
+
+        // Young brothers wait: once the eldest has been searched without a cutoff,
+        // the remaining siblings can be shared with idle threads
+        if (canSplit(depth)) {
+            MoveList rest;
+            for (CompactMove next; (next = picker.NextMove()).IsValid();) {
+                rest.Add(next);
+            }
+            if (!rest.Empty()) {
+                split(thread, board, rest, 0, depth, ply, pvNode, improving, alpha, beta,
+                      bestScore, bestMoveThisDepth, legalMoves, quietsTried.data(), quietCount);
+            }
+            break;
+        }
     }
 
-    TranspositionEntry::BoundType bound;
-    if (score <= alpha) {
-        bound = TranspositionEntry::BoundType::UPPERBOUND;
-    } else if (score >= beta) {
-        bound = TranspositionEntry::BoundType::LOWERBOUND;
+    if (stopped() || cutoffAbove(thread)) {
+        return 0;
+    }
+
+    if (legalMoves == 0) {
+        return inCheck ? MatedIn(ply) : VALUE_DRAW;
+    }
+
+    if (bestScore >= beta && IsQuiet(board, bestMoveThisDepth)) {
+        updateQuietStats(thread, board, ply, bestMoveThisDepth, quietsTried.data(), quietCount, depth);
+    }
+
+    BoundType bound;
+    if (bestScore >= beta) {
+        bound = BoundType::LOWERBOUND;
+    } else if (bestScore > originalAlpha) {
+        bound = BoundType::EXACT;
     } else {
-        bound = TranspositionEntry::BoundType::EXACT;
+        bound = BoundType::UPPERBOUND;
     }
 
-    transpositionTable[zobrist.getHash(board)] = {score, depth, bestMoveThisDepth, bound};
+    transpositionTable.Store(board.GetKey(), scoreToTT(bestScore, ply), depth, bound, bestMoveThisDepth);
 
-    return score;
+    return bestScore;
 }
 
 /**
- * Quiescence search to handle tactical positions.
+ * Quiescence search to handle tactical positions. Only captures and queen promotions
+ * are searched, or every evasion when in check. depth starts at 0 and counts down,
+ * so the search can be cut off before a long capture sequence runs away.
  */
-int Engine::quiescenceSearch(Board& board, int alpha, int beta) {
-    if (timeIsUp()) {
+Value Engine::quiescenceSearch(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta) {
+    if (visitNode(thread)) {
         return 0;
     }
 
-    int standPat = static_cast<int>(board.EvaluatePosition(board.GetCurrentPlayer()));
+    bool inCheck = board.InCheck();
+    Color us = board.GetCurrentPlayer();
+    if (ply >= MAX_PLY || depth <= -QSEARCH_MAX_DEPTH) {
+        return board.Evaluate(us, &thread.pawnTable);
+    }
 
-    if (standPat >= beta) {
-        return beta;
+    TTEntry entry;
+    bool ttHit = transpositionTable.Probe(board.GetKey(), entry);
+    if (ttHit && entry.Depth() >= QSEARCH_TT_DEPTH) {
+        Value ttScore = scoreFromTT(entry.Score(), ply);
+        if (entry.Bound() == BoundType::EXACT
+            || (entry.Bound() == BoundType::LOWERBOUND && ttScore >= beta)
+            || (entry.Bound() == BoundType::UPPERBOUND && ttScore <= alpha)) {
+            return ttScore;
+        }
     }
-    if (standPat > alpha) {
-        alpha = standPat;
+
+    // In check there is no standing pat: every evasion has to be tried
+    int originalAlpha = alpha;
+    Value standPat = 0;
+    Value bestScore = -VALUE_INFINITE;
+    if (!inCheck) {
+        standPat = board.Evaluate(us, &thread.pawnTable);
+        if (standPat >= beta) {
+            return standPat;
+        }
+        if (standPat > alpha) {
+            alpha = standPat;
+        }
+        bestScore = standPat;
     }
 
-    auto legalMoves = board.GetAllLegalMoves(board.GetCurrentPlayer());
-    for (const auto& move : legalMoves) {
-        if (move.capturedPiece.IsEmpty() && !board.IsInCheck(board.GetCurrentPlayer())) {
+    CompactMove bestMove;
+    int legalMoves = 0;
+
+    MovePicker picker(board, ttHit ? entry.Move() : CompactMove(), thread.historyHeuristic);
+    CompactMove move;
+    while ((move = picker.NextMove()).IsValid()) {
+        if (!inCheck) {
+            if (move.Type() == MoveType::PROMOTION && move.Promotion() != PieceType::QUEEN) {
+                continue;
+            }
+
+            // Delta pruning: even winning the captured piece for free leaves us below alpha
+            if (move.Type() != MoveType::PROMOTION) {
+                Value captured = board.GetPieceValue(board.ToMove(move).capturedPiece.type);
+                if (standPat + captured + DELTA_MARGIN <= alpha) {
+                    continue;
+                }
+            }
+
+            // A capture that loses material cannot raise a score that already stood pat
+            if (!board.SEE(move, 0)) {
+                continue;
+            }
+        }
+        if (!board.IsLegal(move)) {
             continue;
         }
-        Board tempBoard = board;
-        if (tempBoard.MakeMove(move)) {
-            int score = -quiescenceSearch(tempBoard, -beta, -alpha);
-            if (score >= beta) {
-                return beta;
-            }
+        ++legalMoves;
+
+        board.DoMove(move);
+        transpositionTable.Prefetch(board.GetKey());
+        Value score = -quiescenceSearch(thread, board, depth - 1, ply + 1, -beta, -alpha);
+        board.UndoMove(move);
+
+        if (stopped()) {
+            return 0;
+        }
+        if (score > bestScore) {
+            bestScore = score;
+            bestMove = move;
             if (score > alpha) {
                 alpha = score;
+                if (alpha >= beta) {
+                    break;
+                }
+            }
+        }
+    }
+
+    if (stopped() || cutoffAbove(thread)) {
+        return 0;
+    }
+
+    if (inCheck && legalMoves == 0) {
+        return MatedIn(ply);
+    }
+
+    BoundType bound;
+    if (bestScore >= beta) {
+        bound = BoundType::LOWERBOUND;
+    } else if (bestScore > originalAlpha) {
+        bound = BoundType::EXACT;
+    } else {
+        bound = BoundType::UPPERBOUND;
+    }
+    transpositionTable.Store(board.GetKey(), scoreToTT(bestScore, ply), QSEARCH_TT_DEPTH, bound, bestMove);
+
+    return bestScore;
+}
+
+/**
+ * Principal variation search of a move after the first: a null-window probe, possibly
+ * reduced, that only turns into a full search if the move looks better than alpha.
+ */
+Value Engine::searchLateMove(SearchThread& thread, Board& board, int depth, int ply, Value alpha, Value beta, int reduction) {
+    Value eval = -alphaBeta(thread, board, depth - reduction, ply + 1, -alpha - 1, -alpha);
+    if (reduction > 0 && eval > alpha) {
+        eval = -alphaBeta(thread, board, depth, ply + 1, -alpha - 1, -alpha);
+    }
+    if (eval > alpha && eval < beta) {
+        eval = -alphaBeta(thread, board, depth, ply + 1, -beta, -alpha);
+    }
+    return eval;
+}
+
+int Engine::lateMoveReduction(int depth, int moveNumber) {
+    return LMR_TABLE[std::min(depth, LMR_TABLE_SIZE - 1)][std::min(moveNumber, LMR_TABLE_SIZE - 1)];
+}
+
+bool Engine::pruneMove(const Board& board, CompactMove move, bool quiet, int depth, bool improving,
+                       Value staticEval, Value alpha, int quietCount, bool& lateMove) {
+    // Late move pruning: past this many quiet moves, the rest are not worth searching
+    int lateMoveLimit = (3 + depth * depth) / (improving ? 1 : 2);
+    lateMove = quiet && depth <= LMP_MAX_DEPTH && quietCount >= lateMoveLimit;
+    if (lateMove) {
+        return true;
+    }
+
+    // Futility pruning: a quiet move is unlikely to make up the distance to alpha
+    if (quiet && depth <= FUTILITY_MAX_DEPTH && staticEval + FUTILITY_MARGIN * (depth + 1) <= alpha) {
+        return true;
+    }
+
+    // SEE pruning: the move loses too much material in the exchange it starts
+    return depth <= SEE_PRUNE_MAX_DEPTH
+        && !board.SEE(move, quiet ? -SEE_QUIET_MARGIN * depth * depth : -SEE_CAPTURE_MARGIN * depth);
+}
+
+/**
+ * The move one ply back was the opponent's, the one two plies back ours. Ours may have
+ * been captured since, and then no longer says anything about the piece on its square.
+ */
+void Engine::continuationTables(SearchThread& thread, const Board& board, PieceToHistory* tables[2]) {
+    for (int i = 0; i < 2; ++i) {
+        tables[i] = nullptr;
+        CompactMove previous = board.PreviousMove(i + 1);
+        if (!previous.IsValid()) continue;
+
+        const Piece& piece = board.PieceOn(previous.To());
+        Color mover = (i == 0) ? Opponent(board.GetCurrentPlayer()) : board.GetCurrentPlayer();
+        if (piece.color == mover) {
+            tables[i] = &thread.continuationHistory[PieceIndex(piece)][previous.To()];
+        }
+    }
+}
+
+/**
+ * History gravity: each update moves a score towards +-HISTORY_MAX by a fraction of
+ * the remaining distance, so the tables never saturate and old results fade.
+ */
+void Engine::updateQuietStats(SearchThread& thread, const Board& board, int ply, CompactMove best,
+                              const CompactMove* quiets, int quietCount, int depth) {
+    auto& history = thread.historyHeuristic[ColorIndex(board.GetCurrentPlayer())];
+    PieceToHistory* contHistory[2];
+    continuationTables(thread, board, contHistory);
+
+    int bonus = std::min(32 * depth * depth, HISTORY_MAX / 4);
+    auto gravity = [](int entry, int delta) {
+        return entry + delta - entry * std::abs(delta) / HISTORY_MAX;
+    };
+    auto update = [&](CompactMove move, int delta) {
+        int& entry = history[move.From()][move.To()];
+        entry = gravity(entry, delta);
+        int piece = PieceIndex(board.PieceOn(move.From()));
+        for (PieceToHistory* continuation : contHistory) {
+            if (continuation) {
+                int16_t& cont = (*continuation)[piece][move.To()];
+                cont = static_cast<int16_t>(gravity(cont, delta));
             }
         }
+    };
+
+    update(best, bonus);
+    for (int i = 0; i < quietCount; ++i) {
+        if (quiets[i] != best) {
+            update(quiets[i], -bonus);
+        }
+    }
+
+    // Killers: the two most recent distinct quiet cutoffs at this ply
+    auto& killers = thread.killerMoves[ply];
+    if (killers[0] != best) {
+        killers[1] = killers[0];
+        killers[0] = best;
     }
-    return alpha;
+
+    // Counter move: this move refuted the opponent's last one
+    CompactMove previous = board.PreviousMove();
+    if (previous.IsValid()) {
+        thread.counterMoves[PieceIndex(board.PieceOn(previous.To()))][previous.To()] = best;
+    }
+}
+
+Value Engine::scoreToTT(Value score, int ply) {
+    if (score >= VALUE_MATE_IN_MAX_PLY) return score + ply;
+    if (score <= -VALUE_MATE_IN_MAX_PLY) return score - ply;
+    return score;
+}
+
+Value Engine::scoreFromTT(Value score, int ply) {
+    if (score >= VALUE_MATE_IN_MAX_PLY) return score - ply;
+    if (score <= -VALUE_MATE_IN_MAX_PLY) return score + ply;
+    return score;
 }
 
 /**
- * Move ordering function.
+ * Move ordering function. Sorts the list in place, best candidates first.
+ * The TT move is only a hint (another thread may have written the entry, or the
+ * 16-bit key may have matched a different position), so it is trusted only if
+ * it is one of the generated moves.
  */
-std::vector<Move> Engine::orderMoves(const Board& board, const std::vector<Move>& moves) {
-    std::vector<std::pair<int, Move>> scoredMoves;
-    for (const auto& move : moves) {
+void Engine::orderMoves(const SearchThread& thread, const Board& board, MoveList& moves, CompactMove ttMove) {
+    std::array<int, MAX_MOVES> scores;
+    for (size_t i = 0; i < moves.Size(); ++i) {
+        CompactMove move = moves[i];
+        const Piece& captured = board.PieceOn(move.To());
         int score = 0;
-        if (!move.capturedPiece.IsEmpty()) {
-            score += 10 * static_cast<int>(board.GetPieceValue(move.capturedPiece.type)) - static_cast<int>(board.GetPieceValue(board.GetPiece(move.from).type));
+        if (!captured.IsEmpty()) {
+            // Captures ahead of every quiet move, however good its history
+            score += 2 * HISTORY_MAX;
+            score += 10 * board.GetPieceValue(captured.type) - board.GetPieceValue(board.PieceOn(move.From()).type);
+        }
+        if (move == ttMove) {
+            score += 1000000;
         }
-        score += historyHeuristic[move.from.y][move.from.x];
-        scoredMoves.push_back({score, move});
+        if (captured.IsEmpty()) {
+            score += thread.historyHeuristic[ColorIndex(board.GetCurrentPlayer())][move.From()][move.To()];
+        }
+        scores[i] = score;
     }
-    std::sort(scoredMoves.begin(), scoredMoves.end(), [](const auto& a, const auto& b) {
-        return a.first > b.first;
-    });
-    std::vector<Move> orderedMoves;
-    for (const auto& pair : scoredMoves) {
-        orderedMoves.push_back(pair.second);
+
+    // Insertion sort: lists are short and mostly need only a few swaps
+    for (size_t i = 1; i < moves.Size(); ++i) {
+        CompactMove move = moves[i];
+        int score = scores[i];
+        size_t j = i;
+        for (; j > 0 && scores[j - 1] < score; --j) {
+            moves[j] = moves[j - 1];
+            scores[j] = scores[j - 1];
+        }
+        moves[j] = move;
+        scores[j] = score;
     }
-    return orderedMoves;
 }
 
 /**
- * Checks if the time limit for the search has been exceeded.
+ * Checks if the time limit for the search has been exceeded. Only the main thread
+ * calls this; helpers just see stopSearch go up.
  */
-bool Engine::timeIsUp() const {
-    auto now = std::chrono::steady_clock::now();
-    return std::chrono::duration_cast<std::chrono::milliseconds>(now - startTime) >= timeLimit;
+void Engine::checkTime() {
+    if (timeManager.Elapsed() >= timeManager.HardLimit()) {
+        stopSearch.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool Engine::visitNode(SearchThread& thread) {
+    if ((++thread.nodes & (TIME_CHECK_NODES - 1)) == 0 && thread.id == 0) {
+        checkTime();
+    }
+    return stopped();
 }
 
 } // namespace Chess
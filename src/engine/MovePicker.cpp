@@ -0,0 +1,208 @@
+#include "engine/MovePicker.h"
+#include <utility>
+
+namespace Chess {
+
+namespace {
+
+// Indexed by PieceType: EMPTY, PAWN, ROOK, KNIGHT, BISHOP, QUEEN, KING
+constexpr int PIECE_VALUES[PIECE_TYPE_NB] = { 0, 100, 500, 320, 330, 900, 20000 };
+
+int PieceValue(PieceType type) {
+    return PIECE_VALUES[static_cast<int>(type)];
+}
+
+PieceType CapturedType(const Board& board, CompactMove move) {
+    return move.Type() == MoveType::EN_PASSANT ? PieceType::PAWN : board.PieceOn(move.To()).type;
+}
+
+bool IsQuietMove(const Board& board, CompactMove move) {
+    return board.PieceOn(move.To()).IsEmpty()
+        && move.Type() != MoveType::EN_PASSANT
+        && move.Type() != MoveType::PROMOTION;
+}
+
+// Most valuable victim first, least valuable attacker among equal victims
+int MvvLva(const Board& board, CompactMove move) {
+    int score = 8 * PieceValue(CapturedType(board, move));
+    if (move.Type() == MoveType::PROMOTION) {
+        score += 8 * PieceValue(move.Promotion());
+    }
+    return score - PieceValue(board.PieceOn(move.From()).type) / 100;
+}
+
+// Evasions that capture go before every quiet evasion
+constexpr int EVASION_CAPTURE_BONUS = 1 << 24;
+
+} // namespace
+
+MovePicker::MovePicker(const Board& board, CompactMove ttMove, const CompactMove* killers, CompactMove counterMove,
+                       const ButterflyHistory& history, const PieceToHistory* const* contHistory)
+    : board(board), history(history), contHistory{ contHistory[0], contHistory[1] },
+      stage(board.InCheck() ? Stage::EVASION_TT : Stage::MAIN_TT), ttMove(ttMove),
+      refutations{ killers[0], killers[1], counterMove }, refutationIndex(0), skipQuiets(false),
+      current(0), badCaptureIndex(0) {
+    // Each refutation is handed out once at most
+    if (refutations[1] == refutations[0]) refutations[1] = CompactMove();
+    if (refutations[2] == refutations[0] || refutations[2] == refutations[1]) refutations[2] = CompactMove();
+}
+
+MovePicker::MovePicker(const Board& board, CompactMove ttMove, const ButterflyHistory& history)
+    : board(board), history(history), contHistory{ nullptr, nullptr },
+      stage(board.InCheck() ? Stage::EVASION_TT : Stage::QSEARCH_TT), ttMove(ttMove),
+      refutations{}, refutationIndex(0), skipQuiets(true), current(0), badCaptureIndex(0) {
+    // Out of check only noisy moves are searched, a quiet TT move is not
+    if (stage == Stage::QSEARCH_TT && board.IsPseudoLegal(ttMove) && IsQuietMove(board, ttMove)) {
+        this->ttMove = CompactMove();
+    }
+}
+
+CompactMove MovePicker::NextMove() {
+    while (true) {
+        switch (stage) {
+            case Stage::MAIN_TT:
+            case Stage::EVASION_TT:
+            case Stage::QSEARCH_TT:
+                stage = (stage == Stage::MAIN_TT) ? Stage::CAPTURE_INIT
+                      : (stage == Stage::EVASION_TT) ? Stage::EVASION_INIT : Stage::QCAPTURE_INIT;
+                if (board.IsPseudoLegal(ttMove)) {
+                    return ttMove;
+                }
+                break;
+
+            case Stage::CAPTURE_INIT:
+                moves.Clear();
+                board.GenerateMoves(GenType::CAPTURES, moves);
+                ScoreCaptures();
+                current = 0;
+                stage = Stage::GOOD_CAPTURE;
+                break;
+
+            case Stage::GOOD_CAPTURE:
+                while (current < moves.Size()) {
+                    CompactMove move = SelectBest();
+                    if (move == ttMove) continue;
+                    if (!board.SEE(move, 0)) {
+                        badCaptures.Add(move);
+                        continue;
+                    }
+                    return move;
+                }
+                stage = Stage::REFUTATION;
+                break;
+
+            case Stage::REFUTATION:
+                while (refutationIndex < refutations.size()) {
+                    CompactMove move = refutations[refutationIndex++];
+                    if (!skipQuiets && move != ttMove && board.IsPseudoLegal(move) && IsQuietMove(board, move)) {
+                        return move;
+                    }
+                }
+                stage = Stage::QUIET_INIT;
+                break;
+
+            case Stage::QUIET_INIT:
+                moves.Clear();
+                if (!skipQuiets) {
+                    board.GenerateMoves(GenType::QUIETS, moves);
+                    ScoreQuiets();
+                }
+                current = 0;
+                stage = Stage::QUIET;
+                break;
+
+            case Stage::QUIET:
+                while (!skipQuiets && current < moves.Size()) {
+                    CompactMove move = SelectBest();
+                    if (move == ttMove || IsRefutation(move)) continue;
+                    return move;
+                }
+                stage = Stage::BAD_CAPTURE;
+                break;
+
+            case Stage::BAD_CAPTURE:
+                if (badCaptureIndex < badCaptures.Size()) {
+                    return badCaptures[badCaptureIndex++];
+                }
+                stage = Stage::DONE;
+                break;
+
+            case Stage::EVASION_INIT:
+                moves.Clear();
+                board.GenerateMoves(GenType::EVASIONS, moves);
+                ScoreEvasions();
+                current = 0;
+                stage = Stage::EVASION;
+                break;
+
+            case Stage::EVASION:
+            case Stage::QCAPTURE:
+                while (current < moves.Size()) {
+                    CompactMove move = SelectBest();
+                    if (move == ttMove) continue;
+                    return move;
+                }
+                stage = Stage::DONE;
+                break;
+
+            case Stage::QCAPTURE_INIT:
+                moves.Clear();
+                board.GenerateMoves(GenType::CAPTURES, moves);
+                ScoreCaptures();
+                current = 0;
+                stage = Stage::QCAPTURE;
+                break;
+
+            case Stage::DONE:
+                return CompactMove();
+        }
+    }
+}
+
+void MovePicker::ScoreCaptures() {
+    for (size_t i = 0; i < moves.Size(); ++i) {
+        scores[i] = MvvLva(board, moves[i]);
+    }
+}
+
+void MovePicker::ScoreQuiets() {
+    const auto& butterfly = history[ColorIndex(board.GetCurrentPlayer())];
+    for (size_t i = 0; i < moves.Size(); ++i) {
+        CompactMove move = moves[i];
+        int piece = PieceIndex(board.PieceOn(move.From()));
+        int score = butterfly[move.From()][move.To()];
+        for (const PieceToHistory* continuation : contHistory) {
+            if (continuation) {
+                score += (*continuation)[piece][move.To()];
+            }
+        }
+        scores[i] = score;
+    }
+}
+
+void MovePicker::ScoreEvasions() {
+    const auto& butterfly = history[ColorIndex(board.GetCurrentPlayer())];
+    for (size_t i = 0; i < moves.Size(); ++i) {
+        CompactMove move = moves[i];
+        scores[i] = IsQuietMove(board, move) ? butterfly[move.From()][move.To()]
+                                             : EVASION_CAPTURE_BONUS + MvvLva(board, move);
+    }
+}
+
+CompactMove MovePicker::SelectBest() {
+    size_t best = current;
+    for (size_t i = current + 1; i < moves.Size(); ++i) {
+        if (scores[i] > scores[best]) {
+            best = i;
+        }
+    }
+    std::swap(moves[current], moves[best]);
+    std::swap(scores[current], scores[best]);
+    return moves[current++];
+}
+
+bool MovePicker::IsRefutation(CompactMove move) const {
+    return move == refutations[0] || move == refutations[1] || move == refutations[2];
+}
+
+} // namespace Chess
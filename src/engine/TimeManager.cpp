@@ -0,0 +1,85 @@
+#include "engine/TimeManager.h"
+#include <algorithm>
+
+namespace Chess {
+
+namespace {
+
+// Hard limit as a multiple of the soft limit, and the largest share of the clock one move may use
+constexpr double HARD_LIMIT_RATIO = 5.0;
+constexpr double MAX_CLOCK_SHARE = 0.8;
+
+// The next iteration is assumed to take this many times as long as the last one
+constexpr double ITERATION_GROWTH = 2.0;
+
+} // namespace
+
+void TimeManager::Init(const TimeControl& timeControl) {
+    using std::chrono::milliseconds;
+
+    startTime = std::chrono::steady_clock::now();
+    iterations = 0;
+    stableIterations = 0;
+    previousScore = 0;
+    previousIterationEnd = milliseconds(0);
+
+    milliseconds remaining = timeControl.remainingTime > milliseconds(0) ? timeControl.remainingTime
+                                                                         : timeControl.baseTime;
+    if (remaining <= milliseconds(0)) {
+        softLimit = UNTIMED_MOVE_TIME;
+        hardLimit = std::chrono::duration_cast<milliseconds>(UNTIMED_MOVE_TIME * HARD_LIMIT_RATIO);
+        return;
+    }
+
+    int movesToGo = timeControl.movesToGo > 0 ? std::min(timeControl.movesToGo, 50) : DEFAULT_MOVES_TO_GO;
+
+    // Time available until the next control, counting the increments still to come and
+    // keeping the overhead of every one of those moves in reserve
+    milliseconds available = remaining + timeControl.increment * (movesToGo - 1) - MOVE_OVERHEAD * (movesToGo + 1);
+    available = std::max(available, milliseconds(1));
+
+    milliseconds maxTime = std::max(
+        std::chrono::duration_cast<milliseconds>(remaining * MAX_CLOCK_SHARE) - MOVE_OVERHEAD, milliseconds(1));
+
+    // Never think less than the minimum, unless the clock itself is nearly out
+    milliseconds minTime = std::max(std::min(MIN_THINK_TIME, remaining / 2), milliseconds(1));
+    maxTime = std::max(maxTime, minTime);
+
+    softLimit = std::clamp(available / movesToGo, minTime, maxTime);
+    hardLimit = std::min(std::chrono::duration_cast<milliseconds>(softLimit * HARD_LIMIT_RATIO), maxTime);
+    hardLimit = std::max(hardLimit, softLimit);
+}
+
+std::chrono::milliseconds TimeManager::Elapsed() const {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime);
+}
+
+bool TimeManager::ShouldStopAfterIteration(bool bestMoveChanged, Value score, double bestMoveNodeShare) {
+    std::chrono::milliseconds elapsed = Elapsed();
+    std::chrono::milliseconds iterationTime = elapsed - previousIterationEnd;
+    previousIterationEnd = elapsed;
+
+    stableIterations = bestMoveChanged ? 0 : stableIterations + 1;
+    int scoreDrop = (iterations > 0) ? previousScore - score : 0;
+    previousScore = score;
+    ++iterations;
+
+    // A best move that just changed gets 40% more time, one stable for several iterations 30% less
+    double stability = std::max(0.7, 1.4 - 0.175 * stableIterations);
+
+    // Up to 50% more while the score is falling, a little less while it rises
+    double falling = 1.0 + std::clamp(scoreDrop, -50, 150) / 300.0;
+
+    // The more of the tree the best move needed, the less doubt about it remains
+    double effort = 1.6 - std::clamp(bestMoveNodeShare, 0.0, 1.0);
+
+    double scaledSoftLimit = softLimit.count() * stability * falling * effort;
+    if (elapsed.count() >= std::min(scaledSoftLimit, static_cast<double>(hardLimit.count()))) {
+        return true;
+    }
+
+    // An iteration cut off by the hard limit is wasted, so do not start one that would be
+    return elapsed.count() + iterationTime.count() * ITERATION_GROWTH > hardLimit.count();
+}
+
+} // namespace Chess
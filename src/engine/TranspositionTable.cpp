@@ -0,0 +1,141 @@
+#include "engine/TranspositionTable.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+namespace Chess {
+
+namespace {
+
+uint16_t KeyCheck(uint64_t key) {
+    return static_cast<uint16_t>(key >> 48);
+}
+
+} // namespace
+
+TranspositionTable::TranspositionTable(size_t sizeMB)
+    : clusterCount(0), clusterMask(0), generation(0) {
+    Resize(sizeMB);
+}
+
+void TranspositionTable::Resize(size_t sizeMB) {
+    size_t maxClusters = std::max<size_t>(sizeMB, 1) * 1024 * 1024 / sizeof(Cluster);
+
+    // Power-of-two count so the index is a mask of the key's low bits
+    size_t clusters = 1;
+    while (clusters * 2 <= maxClusters) {
+        clusters *= 2;
+    }
+
+    table = std::make_unique<Cluster[]>(clusters);
+    clusterCount = clusters;
+    clusterMask = clusters - 1;
+    Clear();
+}
+
+void TranspositionTable::Clear() {
+    for (size_t i = 0; i < clusterCount; ++i) {
+        for (auto& slot : table[i].entries) {
+            slot.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+TTEntry TranspositionTable::Load(const std::atomic<uint64_t>& slot) {
+    uint64_t data = slot.load(std::memory_order_relaxed);
+    TTEntry entry;
+    std::memcpy(&entry, &data, sizeof(entry));
+    return entry;
+}
+
+void TranspositionTable::Save(std::atomic<uint64_t>& slot, const TTEntry& entry) {
+    uint64_t data;
+    std::memcpy(&data, &entry, sizeof(data));
+    slot.store(data, std::memory_order_relaxed);
+}
+
+bool TranspositionTable::Probe(uint64_t key, TTEntry& entry) const {
+    const Cluster& cluster = ClusterFor(key);
+    uint16_t key16 = KeyCheck(key);
+    for (const auto& slot : cluster.entries) {
+        TTEntry candidate = Load(slot);
+        if (candidate.key16 == key16 && !candidate.IsEmpty()) {
+            entry = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::Store(uint64_t key, Value score, int depth, BoundType bound, CompactMove move) {
+    Cluster& cluster = ClusterFor(key);
+    uint16_t key16 = KeyCheck(key);
+
+    // Prefer the slot already holding this position, otherwise the least valuable one:
+    // empty first, then shallow entries left over from earlier searches
+    std::atomic<uint64_t>* replace = &cluster.entries[0];
+    TTEntry old = Load(*replace);
+    int worstValue = std::numeric_limits<int>::max();
+    for (auto& slot : cluster.entries) {
+        TTEntry entry = Load(slot);
+        if (entry.key16 == key16 && !entry.IsEmpty()) {
+            replace = &slot;
+            old = entry;
+            break;
+        }
+        int age = ((256 + generation - entry.Generation()) & 0xFC) / GENERATION_STEP;
+        int value = entry.IsEmpty() ? std::numeric_limits<int>::min() : entry.depth - 8 * age;
+        if (value < worstValue) {
+            worstValue = value;
+            replace = &slot;
+            old = entry;
+        }
+    }
+
+    if (old.key16 == key16 && !old.IsEmpty()) {
+        // Same position: keep a deeper result from this search unless the new one is exact
+        if (bound != BoundType::EXACT && old.Generation() == generation && depth < old.depth - 2) {
+            return;
+        }
+        if (!move.IsValid()) {
+            move = old.Move();
+        }
+    }
+
+    TTEntry entry;
+    entry.key16 = key16;
+    entry.move = move.Raw();
+    entry.score = static_cast<int16_t>(std::clamp(score, -32000, 32000));
+    entry.depth = static_cast<int8_t>(std::clamp(depth, -100, 127));
+    entry.genBound = static_cast<uint8_t>(generation | static_cast<uint8_t>(bound));
+    Save(*replace, entry);
+}
+
+void TranspositionTable::Prefetch(uint64_t key) const {
+    const void* addr = &ClusterFor(key);
+#if defined(_MSC_VER)
+    _mm_prefetch(static_cast<const char*>(addr), _MM_HINT_T0);
+#else
+    __builtin_prefetch(addr);
+#endif
+}
+
+int TranspositionTable::Hashfull() const {
+    size_t samples = std::min<size_t>(clusterCount, 1000 / CLUSTER_SIZE + 1);
+    int used = 0, total = 0;
+    for (size_t i = 0; i < samples; ++i) {
+        for (const auto& slot : table[i].entries) {
+            TTEntry entry = Load(slot);
+            ++total;
+            if (!entry.IsEmpty() && entry.Generation() == generation) ++used;
+        }
+    }
+    return total ? used * 1000 / total : 0;
+}
+
+} // namespace Chess
@@ -243,7 +243,7 @@ namespace Chess {
         return board.ToFEN();
     }
 
-    float GameManager::GetCurrentEvaluation() const {
+    Value GameManager::GetCurrentEvaluation() const {
         return board.EvaluatePosition(Color::WHITE);
     }
 
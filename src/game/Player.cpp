@@ -40,11 +40,14 @@ namespace Chess {
 
     // --- BasicAIPlayer implementation ---
     BasicAIPlayer::BasicAIPlayer(const std::string& name, Color color, Difficulty diff, const PlayerConfig& config)
-        : AIPlayer(name, color, diff, config) {}
+        : AIPlayer(name, color, diff, config), engine(config.hashSizeMB, config.searchThreads) {}
 
     Move BasicAIPlayer::GetMove(const Board& board, std::chrono::milliseconds timeLimit) {
-        // The AI will use its internal engine to find the best move
-        return engine.findBestMove(board, difficulty, config.timeControl);
+        // The AI will use its internal engine to find the best move, budgeting from
+        // what is left on its clock rather than the configured starting time
+        TimeControl timeControl = config.timeControl;
+        timeControl.remainingTime = timeLimit;
+        return engine.findBestMove(board, difficulty, timeControl);
     }
 
     // --- Factory function implementation ---
@@ -4,17 +4,35 @@
 #include <imgui.h>
 #include <imgui-SFML.h>
 
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <thread>
 
 #include "core/Types.h"
 #include "core/Board.h"
+#include "engine/Bench.h"
 #include "game/GameManager.h"
 #include "game/Player.h"
 #include "ui/Gui.h"
 
 using namespace Chess;
 
-int main() {
+int main(int argc, char* argv[]) {
+    // Headless benchmark: EnhancedChessBot bench [threads] [depth]
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        int threads = argc > 2 ? std::stoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+        int depth = argc > 3 ? std::stoi(argv[3]) : 4;
+        RunParallelBench(std::cout, threads, depth);
+        return 0;
+    }
+
+    // Evaluation speed: EnhancedChessBot evalbench [network file]
+    if (argc > 1 && std::string(argv[1]) == "evalbench") {
+        RunEvalBench(std::cout, argc > 2 ? argv[2] : "");
+        return 0;
+    }
+
     std::cout << "Enhanced Chess Bot - Professional Edition v2.0\n";
     std::cout << "Initializing SFML window...\n";
 
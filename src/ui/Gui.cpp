@@ -1120,10 +1120,10 @@ namespace Chess {
 
     void Gui::updateEngineEvaluation() {
         // TODO: Hook into your engine later
-        // For now, just mock some evaluation data
+        // For now, only the score is real (the static evaluation); the search data is mocked
         currentEvaluation.depth = 12;
         currentEvaluation.nodes = 123456;
-        currentEvaluation.score = 0.35f;
+        currentEvaluation.score = ValueToPawns(gameManager.GetCurrentEvaluation());
         currentEvaluation.bestMove = "e2e4";
         currentEvaluation.principalVariation = { "e2e4", "e7e5", "g1f3" };
     }